@@ -14,6 +14,9 @@
 #include <arpa/inet.h>
 #include <csignal>
 
+#include "rtp/probed_session.h"
+#include "rtp/rtp_probes.h"
+
 using namespace jrtplib;
 using namespace std;
 
@@ -73,6 +76,7 @@ void senderThread(RTPSession *session, MediaFrame frame)
 
     while (running) {
         // JRTPLIB 的内部锁会确保 SendPacket 是线程安全的
+        // packet_sent 探针由 ProbedSession 在包真正发出时触发
         int status = session->SendPacket(frame.buf.data(), frame.size, payloadType, false, timestampIncrement);
         
         if (status < 0) {
@@ -106,6 +110,7 @@ void receiverThread(RTPSession *session)
                 RTPPacket *pack;
                 // 从当前源获取所有数据包
                 while ((pack = session->GetNextPacket()) != nullptr) {
+                    RTP_PROBE_RECEIVED(session, pack->GetSSRC(), pack->GetSequenceNumber(), pack->GetTimestamp());
                     cout << "[接收] RTP包, 来自 SSRC " << pack->GetSSRC()
                          << ", 大小=" << pack->GetPayloadLength()
                          << " bytes, 序列号=" << pack->GetSequenceNumber() << endl;
@@ -141,7 +146,7 @@ int main(int argc, char *argv[])
     uint16_t localPort = static_cast<uint16_t>(std::stoi(argv[3]));
 
     // 1. RTP 会话对象
-    RTPSession session;
+    ProbedSession session;
 
     // 2. 配置会话参数
     RTPSessionParams sessionparams;
@@ -12,6 +12,9 @@
 #include <cstring>
 #include <arpa/inet.h>
 
+#include "rtp/probed_session.h"
+#include "rtp/rtp_probes.h"
+
 using namespace jrtplib;
 using namespace std;
 
@@ -61,6 +64,7 @@ void processRTP(RTPSession *session, const MediaFrame& frame)
             do {
                 RTPPacket *pack;
                 while ((pack = session->GetNextPacket()) != nullptr) {
+                    RTP_PROBE_RECEIVED(session, pack->GetSSRC(), pack->GetSequenceNumber(), pack->GetTimestamp());
                     cout << "[接收] RTP包, 来自 SSRC " << pack->GetSSRC()
                          << ", 大小=" << pack->GetPayloadLength()
                          << " bytes, 序列号=" << pack->GetSequenceNumber() << endl;
@@ -74,6 +78,7 @@ void processRTP(RTPSession *session, const MediaFrame& frame)
         auto now = std::chrono::steady_clock::now();
         if (now - lastSendTime >= sendInterval) {
             cout << ">>> 准备发送数据包..." << endl;
+            // packet_sent 探针由 ProbedSession 在包真正发出时触发
             int status = session->SendPacket(frame.buf.data(), frame.size,
                                              96,       // Payload Type for G.711 PCMA
                                              false,    // Marker bit (false for audio frames usually)
@@ -108,7 +113,7 @@ int main(int argc, char *argv[])
     uint16_t localPort = static_cast<uint16_t>(std::stoi(argv[3]));
 
     // RTP 会话
-    RTPSession session;
+    ProbedSession session;
 
     RTPSessionParams sessionparams;
     sessionparams.SetOwnTimestampUnit(1.0 / 8000.0); // 8kHz
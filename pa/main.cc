@@ -4,6 +4,8 @@
 #include <cmath>
 #include <mutex>
 
+#include "signal_gen.h"
+
 #define SAMPLE_RATE       8000
 #define FRAMES_PER_BUFFER 160
 #define NUM_CHANNELS      1
@@ -14,10 +16,11 @@ using SampleType = int16_t;
 std::ofstream pcmOutFile;
 std::mutex fileMutex;
 
-float sinePhase = 0.0f;
-const float TWO_PI = 2 * M_PI;
 const float FREQUENCY = 440.0f;
 
+// 降低振幅避免破音；回调里不调用 std::sin
+Oscillator sine(FREQUENCY, SAMPLE_RATE, 0.3f);
+
 // 麦克风录音回调，写入文件
 static int recordCallback(const void *inputBuffer, void *outputBuffer,
                           unsigned long framesPerBuffer,
@@ -46,15 +49,7 @@ static int playCallback(const void *inputBuffer, void *outputBuffer,
                         void *userData)
 {
     SampleType *output = static_cast<SampleType *>(outputBuffer);
-
-    for (unsigned long i = 0; i < framesPerBuffer; ++i) {
-        float sample = std::sin(sinePhase) * 0.3f;           // 降低振幅避免破音
-        output[i] = static_cast<SampleType>(sample * 32767); // 转换为 16-bit PCM
-
-        sinePhase += TWO_PI * FREQUENCY / SAMPLE_RATE;
-        if (sinePhase >= TWO_PI)
-            sinePhase -= TWO_PI;
-    }
+    sine.generatePcm16(output, framesPerBuffer); // 转换为 16-bit PCM
 
     return paContinue;
 }
@@ -0,0 +1,163 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <dirent.h>
+
+#include "call_archive.h"
+#include "rtp_packet.h"
+
+/*
+录音归档基准：
+1. 写入：CALLS 通并发呼叫，每通每 20ms 一个 172 字节 RTP 包 (PCMU 160 字节负载)，
+   WRITER_THREADS 个线程各负责一部分呼叫，按模拟时间尽快写入，统计记录/秒和 MB/秒；
+2. 随机读取：重新打开归档，随机挑呼叫和起始时间，取出 1 秒 (50 条记录)，统计时延分布。
+用法: bench_archive [归档目录] [模拟秒数]
+归档目录必须不存在或为空，不指定时在 /tmp 下新建临时目录；结束时只删除本程序写入的文件和目录。
+*/
+
+#define CALLS 5000
+#define PACKETS_PER_SECOND 50
+#define PACKET_SIZE 172
+#define WRITER_THREADS 4
+#define SEGMENT_BYTES (64u << 20)
+#define EXTRACTIONS 100000
+#define EXTRACT_MS 1000
+
+static double elapsedSec(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void writer(ArchiveWriter *archive, int first, int last, int seconds) {
+    uint8_t packet[PACKET_SIZE];
+    memset(packet, 0xff, sizeof(packet));
+    RtpHeader h;
+    h.payloadType = 0;
+    for (int n = 0; n < seconds * PACKETS_PER_SECOND; ++n) {
+        uint64_t timeNs = static_cast<uint64_t>(n) * 20000000;
+        for (int c = first; c < last; ++c) {
+            h.seq = static_cast<uint16_t>(n);
+            h.timestamp = static_cast<uint32_t>(n * 160);
+            h.ssrc = static_cast<uint32_t>(c);
+            rtpWriteHeader(packet, h);
+            // 各呼叫起始时间错开一点
+            archive->append(c, timeNs + c * 1000, ARCHIVE_RTP, packet, sizeof(packet));
+        }
+    }
+}
+
+// 目录不存在时创建；已存在时必须为空，避免混进或删掉别人的文件
+static bool prepareDir(const std::string &dir) {
+    if (mkdir(dir.c_str(), 0755) == 0) {
+        return true;
+    }
+    if (errno != EEXIST) {
+        return false;
+    }
+    DIR *d = opendir(dir.c_str());
+    if (!d) {
+        return false;
+    }
+    bool empty = true;
+    while (dirent *e = readdir(d)) {
+        if (strcmp(e->d_name, ".") != 0 && strcmp(e->d_name, "..") != 0) {
+            empty = false;
+            break;
+        }
+    }
+    closedir(d);
+    return empty;
+}
+
+// 只删除 ArchiveWriter 写出的文件，再删 (空) 目录
+static void removeArchive(const std::string &dir) {
+    unlink((dir + "/index.dat").c_str());
+    for (uint32_t id = 1; unlink(archiveSegmentPath(dir, id).c_str()) == 0; ++id) {
+    }
+    rmdir(dir.c_str());
+}
+
+int main(int argc, char *argv[]) {
+    std::string dir;
+    if (argc > 1) {
+        dir = argv[1];
+        if (!prepareDir(dir)) {
+            std::cerr << dir << " is not an empty directory" << std::endl;
+            return 1;
+        }
+    } else {
+        char tmpl[] = "/tmp/bench_archive.XXXXXX";
+        if (!mkdtemp(tmpl)) {
+            perror("mkdtemp");
+            return 1;
+        }
+        dir = tmpl;
+    }
+    int seconds = argc > 2 ? atoi(argv[2]) : 4;
+
+    size_t records = static_cast<size_t>(CALLS) * seconds * PACKETS_PER_SECOND;
+    double ingestSec;
+    {
+        ArchiveWriter archive(dir, SEGMENT_BYTES);
+        if (!archive.open()) {
+            std::cerr << "Cannot open archive in " << dir << std::endl;
+            removeArchive(dir);
+            return 1;
+        }
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < WRITER_THREADS; ++t) {
+            threads.emplace_back(writer, &archive, CALLS * t / WRITER_THREADS,
+                                 CALLS * (t + 1) / WRITER_THREADS, seconds);
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+        for (int c = 0; c < CALLS; ++c) {
+            archive.closeCall(c);
+        }
+        ingestSec = elapsedSec(start);
+    }
+
+    double mb = records * (sizeof(ArchiveRecordHeader) + PACKET_SIZE) / 1e6;
+    std::cout << "ingest:  " << CALLS << " calls x " << seconds << " s, " << records << " records in "
+              << ingestSec << " s -> " << records / ingestSec / 1e6 << " M records/s, "
+              << mb / ingestSec << " MB/s ("
+              << records / ingestSec / (CALLS * PACKETS_PER_SECOND) << "x real time)" << std::endl;
+
+    ArchiveReader reader(dir);
+    bool readable = reader.open();
+    // 读取端的映射在删除后仍然有效
+    removeArchive(dir);
+    if (!readable) {
+        std::cerr << "Cannot open archive for reading" << std::endl;
+        return 1;
+    }
+
+    std::mt19937 rng(12345);
+    std::vector<double> latencies(EXTRACTIONS);
+    uint64_t sink = 0;
+    size_t extracted = 0;
+    uint32_t spanMs = static_cast<uint32_t>(seconds * 1000 - EXTRACT_MS);
+    for (int i = 0; i < EXTRACTIONS; ++i) {
+        uint64_t callId = rng() % CALLS;
+        uint32_t from = spanMs > 0 ? rng() % spanMs : 0;
+        auto start = std::chrono::steady_clock::now();
+        extracted += reader.extract(callId, from, from + EXTRACT_MS, [&](const ArchiveReader::Record &r) {
+            sink += r.data[r.length - 1] + rtpGet16(r.data + 2);
+        });
+        latencies[i] = elapsedSec(start) * 1e6;
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    std::cout << "extract: " << EXTRACTIONS << " random " << EXTRACT_MS << " ms ranges, "
+              << extracted / EXTRACTIONS << " records each, p50 " << latencies[EXTRACTIONS / 2]
+              << " us, p99 " << latencies[EXTRACTIONS * 99 / 100] << " us, max " << latencies.back()
+              << " us (checksum " << sink << ")" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,223 @@
+#include <iostream>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+
+#include "coro_session.h"
+
+/*
+每通呼叫的内存和切换开销：协程会话 vs 每呼叫两个线程。
+
+协程：N 个对话协程，每个 tick 给每个会话投递一帧，协程取帧、算能量，
+每 50 帧 play() 一段回复。用模拟时钟驱动 EventLoop，测的是纯调度开销。
+线程：N 个呼叫各有接收/发送两个线程，主线程每个 tick 通过条件变量给每个接收线程投递一帧，
+发送线程每 50 帧被唤醒一次。
+用法: bench_coro [呼叫数] [tick 数]
+*/
+
+#define FRAME_BYTES 320
+#define REPLY_EVERY 50
+
+using namespace coro;
+
+static long rssKb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmRSS:") == 0) {
+            return atol(line.c_str() + 6);
+        }
+    }
+    return 0;
+}
+
+// 内存回环：每个 tick 置一次 pending
+class LoopbackTransport : public FrameTransport {
+public:
+    bool pending = false;
+    size_t sent = 0;
+
+    bool receive(std::vector<uint8_t> &frame) override {
+        if (!pending) {
+            return false;
+        }
+        pending = false;
+        frame.assign(FRAME_BYTES, 0x55);
+        return true;
+    }
+    void send(const uint8_t *, size_t len) override { sent += len; }
+};
+
+static uint64_t coroResumes = 0;
+
+static Task dialog(LoopbackTransport *t, const std::vector<uint8_t> *reply) {
+    CoroSession s(t);
+    uint64_t energy = 0;
+    for (unsigned n = 1;; ++n) {
+        std::vector<uint8_t> frame = co_await s.next_frame();
+        ++coroResumes;
+        if (frame.empty()) {
+            break;
+        }
+        for (uint8_t b : frame) {
+            energy += b;
+        }
+        if (n % REPLY_EVERY == 0) {
+            co_await s.play(*reply);
+            ++coroResumes;
+        }
+    }
+}
+
+static void benchCoroutines(int calls, int ticks) {
+    EventLoop loop;
+    std::vector<LoopbackTransport> transports(calls);
+    std::vector<uint8_t> reply(FRAME_BYTES, 0x7f);
+
+    long rssBefore = rssKb();
+    for (int i = 0; i < calls; ++i) {
+        loop.spawn(dialog(&transports[i], &reply));
+    }
+    Clock::time_point now = Clock::now();
+    loop.runOnce(now);
+    long rssAfter = rssKb();
+    size_t frameBytes = Task::promise_type::liveBytes / calls;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int k = 0; k < ticks; ++k) {
+        for (auto &t : transports) {
+            t.pending = true;
+        }
+        now += std::chrono::milliseconds(20);
+        loop.runOnce(now);
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "coroutines: " << calls << " calls, coroutine frame " << frameBytes
+              << " B/call, RSS +" << (rssAfter - rssBefore) * 1024 / calls << " B/call, "
+              << ns / coroResumes << " ns/resume (" << coroResumes << " resumes)" << std::endl;
+}
+
+struct ThreadCall {
+    std::mutex m;
+    std::condition_variable cv;
+    int frames = 0;
+    int replies = 0;
+    bool stop = false;
+};
+
+static std::mutex doneMutex;
+static std::condition_variable doneCv;
+static long pendingHandoffs = 0;
+static uint64_t threadSwitches = 0;
+
+static void handoffDone() {
+    std::lock_guard<std::mutex> lock(doneMutex);
+    ++threadSwitches;
+    if (--pendingHandoffs == 0) {
+        doneCv.notify_one();
+    }
+}
+
+static void callReceiver(ThreadCall *c) {
+    std::vector<uint8_t> frame(FRAME_BYTES);
+    unsigned n = 0;
+    std::unique_lock<std::mutex> lock(c->m);
+    while (true) {
+        c->cv.wait(lock, [c] { return c->frames > 0 || c->stop; });
+        if (c->stop) {
+            return;
+        }
+        --c->frames;
+        if (++n % REPLY_EVERY == 0) {
+            ++c->replies;
+            c->cv.notify_all();
+        }
+        lock.unlock();
+        handoffDone();
+        lock.lock();
+    }
+}
+
+static void callSender(ThreadCall *c) {
+    std::unique_lock<std::mutex> lock(c->m);
+    while (true) {
+        c->cv.wait(lock, [c] { return c->replies > 0 || c->stop; });
+        if (c->stop) {
+            return;
+        }
+        --c->replies;
+        lock.unlock();
+        handoffDone();
+        lock.lock();
+    }
+}
+
+static void benchThreads(int calls, int ticks) {
+    std::vector<ThreadCall> state(calls);
+    std::vector<std::thread> threads;
+    long rssBefore = rssKb();
+    try {
+        for (int i = 0; i < calls; ++i) {
+            threads.emplace_back(callReceiver, &state[i]);
+            threads.emplace_back(callSender, &state[i]);
+        }
+    } catch (const std::system_error &e) {
+        std::cout << "threads: could only create " << threads.size() << " threads: " << e.what() << std::endl;
+        calls = 0;
+    }
+    long rssAfter = rssKb();
+
+    pthread_attr_t attr;
+    size_t stackSize = 0;
+    pthread_attr_init(&attr);
+    pthread_attr_getstacksize(&attr, &stackSize);
+    pthread_attr_destroy(&attr);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int k = 0; k < ticks && calls > 0; ++k) {
+        {
+            std::lock_guard<std::mutex> lock(doneMutex);
+            // 每 REPLY_EVERY 帧接收线程还会唤醒一次发送线程
+            pendingHandoffs = calls + ((k + 1) % REPLY_EVERY == 0 ? calls : 0);
+        }
+        for (int i = 0; i < calls; ++i) {
+            std::lock_guard<std::mutex> lock(state[i].m);
+            ++state[i].frames;
+            state[i].cv.notify_all();
+        }
+        std::unique_lock<std::mutex> lock(doneMutex);
+        doneCv.wait(lock, [] { return pendingHandoffs == 0; });
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    for (auto &c : state) {
+        std::lock_guard<std::mutex> lock(c.m);
+        c.stop = true;
+        c.cv.notify_all();
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    if (calls > 0) {
+        std::cout << "threads:    " << calls << " calls, stack reserve " << 2 * stackSize / 1024
+                  << " KiB/call, RSS +" << (rssAfter - rssBefore) * 1024 / calls << " B/call, "
+                  << ns / threadSwitches << " ns/wakeup (" << threadSwitches << " wakeups)" << std::endl;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int calls = argc > 1 ? atoi(argv[1]) : 10000;
+    int ticks = argc > 2 ? atoi(argv[2]) : 100;
+
+    benchCoroutines(calls, ticks);
+    benchThreads(calls, ticks);
+
+    return 0;
+}
@@ -0,0 +1,246 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <vector>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "fanout.h"
+#include "pipeline.h"
+#include "rtp_packet.h"
+
+/*
+RtpFanout 验证和 CPU 对比：
+1. 4 个收听方在回环上收包，检查各自的 SSRC、连续序列号、时间戳偏移和负载；
+2. 组播：两个套接字在 127.0.0.1 上加入同一组，发一次两边都收到 (回环不支持组播时跳过)；
+3. 每 20ms 一帧 G.711 μ-law，对比每路单独编码/打包/sendto 与编码一次 + sendmmsg 扇出，
+   收听方 1~2000 个。收包端不读，满了由内核丢弃，两种方式一样。CPU 用进程 CPU 时间 (含内核发送路径)。
+用法: bench_fanout [最大收听方数]
+*/
+
+#define SAMPLE_RATE 8000
+#define FRAME 160
+#define MEDIA_PT 0
+#define SINKS 8
+#define TARGET_PACKETS 200000
+
+static double cpuSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// 绑定到 127.0.0.1 的临时端口，返回端口 (主机字节序)
+static int bindLoopback(int fd, uint16_t *port) {
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 ||
+        getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &len) < 0) {
+        return -1;
+    }
+    *port = ntohs(addr.sin_port);
+    return 0;
+}
+
+static void makeFrame(int n, int16_t *pcm) {
+    for (int i = 0; i < FRAME; ++i) {
+        pcm[i] = static_cast<int16_t>(((n * FRAME + i) * 37 % 2000 - 1000) * 8);
+    }
+}
+
+static size_t buildPacket(int n, uint32_t ssrc, uint8_t *packet) {
+    int16_t pcm[FRAME];
+    uint8_t ulaw[FRAME];
+    makeFrame(n, pcm);
+    for (int i = 0; i < FRAME; ++i) {
+        ulaw[i] = pipeline::ulawEncodeSample(pcm[i]);
+    }
+    RtpHeader h;
+    h.payloadType = MEDIA_PT;
+    h.marker = n == 0;
+    h.seq = static_cast<uint16_t>(n);
+    h.timestamp = static_cast<uint32_t>(n * FRAME);
+    h.ssrc = ssrc;
+    return rtpBuildPacket(packet, RTP_MAX_PACKET, h, ulaw, FRAME);
+}
+
+static bool validate(int tx) {
+    const int listeners = 4;
+    const int frames = 50;
+    RtpFanout fanout(tx);
+    int rx[listeners];
+    for (int i = 0; i < listeners; ++i) {
+        uint16_t port;
+        rx[i] = socket(AF_INET, SOCK_DGRAM, 0);
+        if (rx[i] < 0 || bindLoopback(rx[i], &port) < 0) {
+            perror("listener");
+            return false;
+        }
+        timeval tv = {1, 0};
+        setsockopt(rx[i], SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        fanout.addDestination(INADDR_LOOPBACK, port, 0x1000 + i, static_cast<uint16_t>(65530 + i), 1000u * (i + 1));
+    }
+    fanout.addDestination(INADDR_LOOPBACK, 1, 0x1000); // 重复 SSRC 被拒绝
+    fanout.removeDestination(0x1003);
+
+    uint8_t packet[RTP_MAX_PACKET];
+    uint8_t in[RTP_MAX_PACKET];
+    bool ok = fanout.destinations() == 3;
+    for (int n = 0; n < frames; ++n) {
+        size_t len = buildPacket(n, 0xabcd, packet);
+        int sent = fanout.send(packet, len);
+        ok = ok && sent == 3;
+        for (int i = 0; i < 3; ++i) {
+            ssize_t r = recv(rx[i], in, sizeof(in), 0);
+            RtpHeader h;
+            size_t off = r > 0 ? rtpParseHeader(in, r, h) : 0;
+            ok = ok && off == RTP_HEADER_SIZE && static_cast<size_t>(r) == len && h.ssrc == 0x1000u + i &&
+                 h.seq == static_cast<uint16_t>(65530 + i + n) && h.timestamp == n * FRAME + 1000u * (i + 1) &&
+                 h.marker == (n == 0) && h.payloadType == MEDIA_PT &&
+                 memcmp(in + off, packet + RTP_HEADER_SIZE, len - RTP_HEADER_SIZE) == 0;
+        }
+    }
+    for (int i = 0; i < listeners; ++i) {
+        close(rx[i]);
+    }
+    std::cout << "unicast: 3 listeners x " << frames << " frames: " << (ok ? "ok" : "MISMATCH") << std::endl;
+    return ok;
+}
+
+static void multicast() {
+    const uint32_t group = 0xefff2a01; // 239.255.42.1
+    int tx = socket(AF_INET, SOCK_DGRAM, 0);
+    int rx[2];
+    uint16_t port = 0;
+    bool setup = tx >= 0 && fanoutSetMulticast(tx, INADDR_LOOPBACK, 1, true) == 0;
+    for (int i = 0; i < 2; ++i) {
+        rx[i] = socket(AF_INET, SOCK_DGRAM, 0);
+        int on = 1;
+        setsockopt(rx[i], SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(group);
+        addr.sin_port = htons(port);
+        socklen_t len = sizeof(addr);
+        setup = setup && bind(rx[i], reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0 &&
+                getsockname(rx[i], reinterpret_cast<sockaddr *>(&addr), &len) == 0 &&
+                fanoutJoinGroup(rx[i], group, INADDR_LOOPBACK) == 0;
+        port = ntohs(addr.sin_port);
+        timeval tv = {0, 200000};
+        setsockopt(rx[i], SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    }
+
+    int received = 0;
+    if (setup) {
+        RtpFanout fanout(tx);
+        fanout.addDestination(group, port, 0x2000);
+        uint8_t packet[RTP_MAX_PACKET];
+        uint8_t in[RTP_MAX_PACKET];
+        for (int n = 0; n < 10; ++n) {
+            fanout.send(packet, buildPacket(n, 0xabcd, packet));
+        }
+        for (int i = 0; i < 2; ++i) {
+            while (recv(rx[i], in, sizeof(in), 0) > 0) {
+                ++received;
+            }
+        }
+    }
+    if (!setup || received == 0) {
+        std::cout << "multicast on loopback: unavailable here (" << strerror(errno) << "), skipped" << std::endl;
+    } else {
+        std::cout << "multicast 239.255.42.1 via 127.0.0.1: 1 destination, 10 frames, 2 members received "
+                  << received << " packets" << std::endl;
+    }
+    close(tx);
+    close(rx[0]);
+    close(rx[1]);
+}
+
+// 每路单独编码、打包、sendto
+static double perLeg(int tx, const std::vector<sockaddr_in> &sinks, int listeners, int frames) {
+    uint8_t packet[RTP_MAX_PACKET];
+    double t0 = cpuSeconds();
+    for (int n = 0; n < frames; ++n) {
+        for (int l = 0; l < listeners; ++l) {
+            size_t len = buildPacket(n, 0x3000 + l, packet);
+            const sockaddr_in &dest = sinks[l % SINKS];
+            sendto(tx, packet, len, 0, reinterpret_cast<const sockaddr *>(&dest), sizeof(dest));
+        }
+    }
+    return cpuSeconds() - t0;
+}
+
+// 编码打包一次，RtpFanout 扇出
+static double fannedOut(int tx, const std::vector<sockaddr_in> &sinks, int listeners, int frames) {
+    RtpFanout fanout(tx);
+    for (int l = 0; l < listeners; ++l) {
+        const sockaddr_in &dest = sinks[l % SINKS];
+        fanout.addDestination(ntohl(dest.sin_addr.s_addr), ntohs(dest.sin_port), 0x3000 + l);
+    }
+    uint8_t packet[RTP_MAX_PACKET];
+    double t0 = cpuSeconds();
+    for (int n = 0; n < frames; ++n) {
+        fanout.send(packet, buildPacket(n, 0xabcd, packet));
+    }
+    return cpuSeconds() - t0;
+}
+
+int main(int argc, char *argv[]) {
+    int maxListeners = argc > 1 ? atoi(argv[1]) : 2000;
+
+    int tx = socket(AF_INET, SOCK_DGRAM, 0);
+    if (tx < 0) {
+        perror("socket");
+        return 1;
+    }
+    bool ok = validate(tx);
+    multicast();
+
+    std::vector<int> sinkFds;
+    std::vector<sockaddr_in> sinks;
+    for (int i = 0; i < SINKS; ++i) {
+        int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        uint16_t port;
+        if (fd < 0 || bindLoopback(fd, &port) < 0) {
+            perror("sink");
+            return 1;
+        }
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        sinkFds.push_back(fd);
+        sinks.push_back(addr);
+    }
+
+    std::cout << "CPU per 20 ms frame (G.711, " << FRAME << " byte payload), listeners on " << SINKS
+              << " loopback sinks" << std::endl;
+    std::cout << "listeners   per-leg us/frame   fan-out us/frame   speedup   fan-out us/listener   "
+                 "listeners/core" << std::endl;
+    for (int listeners : {1, 10, 50, 100, 500, 1000, 2000}) {
+        if (listeners > maxListeners) {
+            break;
+        }
+        int frames = TARGET_PACKETS / listeners < 50 ? 50 : TARGET_PACKETS / listeners;
+        double leg = perLeg(tx, sinks, listeners, frames) * 1e6 / frames;
+        double fan = fannedOut(tx, sinks, listeners, frames) * 1e6 / frames;
+        std::cout << std::fixed << std::setprecision(1) << std::setw(9) << listeners << std::setw(19) << leg
+                  << std::setw(19) << fan << std::setw(9) << leg / fan << "x" << std::setprecision(2)
+                  << std::setw(22) << fan / listeners << std::setprecision(0) << std::setw(17)
+                  << 1e6 / (fan / listeners * SAMPLE_RATE / FRAME) << std::endl;
+    }
+
+    for (int fd : sinkFds) {
+        close(fd);
+    }
+    close(tx);
+    return ok ? 0 : 1;
+}
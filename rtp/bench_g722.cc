@@ -0,0 +1,211 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <vector>
+
+#include "g722.h"
+#include "signal_gen.h"
+
+/*
+G.722 验证和吞吐：
+1. 已知答案：复位状态下一对子带样本的码字和一个码字的重建值，按 G.722 的量化表手算 (见 knownAnswers)；
+2. 逐帧向量化的 QMF 与逐样本计算 (每次只编解码一个样本对，全走标量路径) 输出逐字节/逐样本一致；
+3. 编解码往返的 SNR：扫频和几个单音，3.4kHz 以上的单音窄带编码过不去，G.722 能过；
+4. 吞吐：CHANNELS 路各 20ms 一帧编码+解码，统计单核能实时处理多少路全双工。
+按 ITU 测试序列验证完整的位精确用 g722_vectors (序列需自行下载)。
+用法: bench_g722 [路数] [秒数]
+*/
+
+#define FRAME_MS 20
+#define FRAME_SAMPLES (G722_SAMPLE_RATE * FRAME_MS / 1000)
+
+static std::vector<int16_t> render(double seconds, double freq, double dbov) {
+    std::vector<float> out(static_cast<size_t>(seconds * G722_SAMPLE_RATE));
+    if (freq > 0) {
+        Oscillator osc(freq, G722_SAMPLE_RATE, sigDbovToAmplitude(dbov));
+        osc.generate(out.data(), out.size());
+    } else {
+        Sweep sweep(50, 7500, seconds, G722_SAMPLE_RATE, sigDbovToAmplitude(dbov));
+        sweep.generate(out.data(), out.size());
+    }
+    std::vector<int16_t> pcm(out.size());
+    sigToPcm16(out.data(), pcm.data(), out.size());
+    return pcm;
+}
+
+// 按 step 个样本一次编解码
+static void roundtrip(const std::vector<int16_t> &in, size_t step, std::vector<uint8_t> &code,
+                      std::vector<int16_t> &out) {
+    G722Encoder enc;
+    G722Decoder dec;
+    code.resize(in.size() / 2);
+    out.resize(in.size());
+    for (size_t i = 0; i < in.size(); i += step) {
+        enc.encode(in.data() + i, step, code.data() + i / 2);
+        dec.decode(code.data() + i / 2, step / 2, out.data() + i);
+    }
+}
+
+// 在 0..63 个样本的延迟里取最好的 SNR (跳过开头 100ms 的收敛)
+static double snr(const std::vector<int16_t> &in, const std::vector<int16_t> &out, int *delay) {
+    double best = -100;
+    size_t skip = G722_SAMPLE_RATE / 10;
+    for (int d = 0; d < 64; ++d) {
+        double sig = 0, err = 0;
+        for (size_t i = skip; i + d < out.size(); ++i) {
+            double e = static_cast<double>(out[i + d]) - in[i];
+            sig += static_cast<double>(in[i]) * in[i];
+            err += e * e;
+        }
+        double v = 10 * std::log10(sig / (err + 1));
+        if (v > best) {
+            best = v;
+            *delay = d;
+        }
+    }
+    return best;
+}
+
+/*
+复位状态 (低带 det = 32，高带 det = 8，预测值为 0) 下只有量化/反量化表参与，可以手算：
+- 低带：wd = el >= 0 ? el : -(el + 1)，取第一个 wd < (q6[i] * 32) >> 12 的 i，码字 ilp[i] / iln[i]，
+  例如 el = 1：门限依次为 0,0,0,1,1,1,2 -> i = 7，ilp[7] = 55；el 超过所有门限时 i = 30；
+- 高带：门限 (564 * 8) >> 12 = 1，wd < 1 取 ihp[1] = 3 / ihn[1] = 1，否则 ihp[2] = 2 / ihn[2] = 0；
+- 解码：rlow = (32 * qm6/qm5/qm4[...]) >> 15，rhigh = (8 * qm2[ihigh]) >> 15 (算术右移，向下取整)，
+  例如 0x04：(32 * -24808) >> 15 = -25，(8 * -7408) >> 15 = -2。
+*/
+struct EncodeAnswer {
+    int xlow, xhigh;
+    uint8_t code;
+};
+
+struct DecodeAnswer {
+    int mode;
+    uint8_t code;
+    int rlow, rhigh;
+};
+
+static const EncodeAnswer encodeAnswers[] = {
+    {0, 0, 0xfa},      // ihigh 3, ilow ilp[4] = 58
+    {-1, -1, 0x5e},    // 1, iln[4] = 30
+    {1, 5, 0xb7},      // 2, ilp[7] = 55
+    {5, -5, 0x2e},     // 0, ilp[16] = 46
+    {-6, 0, 0xd2},     // 3, iln[16] = 18
+    {100, -100, 0x20}, // 0, ilp[30] = 32
+    {-100, 100, 0x84}, // 2, iln[30] = 4
+};
+
+static const DecodeAnswer decodeAnswers[] = {
+    {1, 0xfa, 1, 0},    // qm6[58] = 1040, qm2[3] = 1616
+    {1, 0x04, -25, -2}, // qm6[4] = -24808, qm2[0] = -7408
+    {1, 0x60, 24, -1},  // qm6[32] = 24808, qm2[1] = -1616
+    {2, 0xa0, 22, 1},   // qm5[16] = 23352, qm2[2] = 7408
+    {3, 0x20, 19, -2},  // qm4[8] = 20456
+};
+
+static bool knownAnswers() {
+    size_t bad = 0;
+    for (const EncodeAnswer &a : encodeAnswers) {
+        G722Encoder enc;
+        uint8_t code = enc.encodeBands(a.xlow, a.xhigh);
+        if (code != a.code) {
+            std::cout << "  encode (" << a.xlow << ", " << a.xhigh << "): got 0x" << std::hex << static_cast<int>(code)
+                      << ", expected 0x" << static_cast<int>(a.code) << std::dec << std::endl;
+            ++bad;
+        }
+    }
+    for (const DecodeAnswer &a : decodeAnswers) {
+        G722Decoder dec(a.mode);
+        int rlow, rhigh;
+        dec.decodeBands(a.code, &rlow, &rhigh);
+        if (rlow != a.rlow || rhigh != a.rhigh) {
+            std::cout << "  decode mode " << a.mode << " 0x" << std::hex << static_cast<int>(a.code) << std::dec << ": got ("
+                      << rlow << ", " << rhigh << "), expected (" << a.rlow << ", " << a.rhigh << ")" << std::endl;
+            ++bad;
+        }
+    }
+    size_t total = sizeof(encodeAnswers) / sizeof(encodeAnswers[0]) + sizeof(decodeAnswers) / sizeof(decodeAnswers[0]);
+    std::cout << "known answers: " << total << " checked, " << bad << " wrong" << std::endl;
+    return bad == 0;
+}
+
+static bool validate() {
+    bool ok = knownAnswers();
+    std::vector<int16_t> in = render(2, 0, -10);
+    std::vector<uint8_t> codeFrame, codeSample;
+    std::vector<int16_t> outFrame, outSample;
+    roundtrip(in, FRAME_SAMPLES, codeFrame, outFrame);
+    roundtrip(in, 2, codeSample, outSample);
+    bool same = codeFrame == codeSample && outFrame == outSample;
+    ok = ok && same;
+    std::cout << "vector QMF (" << G722_LANES << " lanes) vs per-sample: " << (same ? "identical" : "MISMATCH")
+              << std::endl;
+
+    std::cout << std::fixed << std::setprecision(1);
+    int delay = 0;
+    double v = snr(in, outFrame, &delay);
+    std::cout << "sweep 50-7500 Hz -10 dBov: SNR " << v << " dB, delay " << delay << " samples" << std::endl;
+    for (double f : {300.0, 1000.0, 3000.0, 5000.0, 6500.0}) {
+        for (double level : {-10.0, -30.0}) {
+            std::vector<int16_t> tone = render(1, f, level);
+            std::vector<uint8_t> code;
+            std::vector<int16_t> out;
+            roundtrip(tone, FRAME_SAMPLES, code, out);
+            v = snr(tone, out, &delay);
+            ok = ok && v > 10;
+            std::cout << "  " << std::setw(6) << f << " Hz " << std::setw(5) << level << " dBov: SNR "
+                      << std::setw(5) << v << " dB" << std::endl;
+        }
+    }
+    return ok;
+}
+
+static void throughput(int channels, int seconds) {
+    std::vector<int16_t> in = render(2, 0, -10);
+    size_t frames = in.size() / FRAME_SAMPLES;
+    std::vector<G722Encoder> enc(channels);
+    std::vector<G722Decoder> dec(channels);
+    uint8_t code[FRAME_SAMPLES / 2];
+    int16_t out[FRAME_SAMPLES];
+    int ticks = seconds * 1000 / FRAME_MS;
+    uint64_t check = 0;
+
+    double encSec = 0, decSec = 0;
+    for (int t = 0; t < ticks; ++t) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (int c = 0; c < channels; ++c) {
+            enc[c].encode(in.data() + ((t + c) % frames) * FRAME_SAMPLES, FRAME_SAMPLES, code);
+            check += code[c % sizeof(code)];
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        for (int c = 0; c < channels; ++c) {
+            dec[c].decode(code, sizeof(code), out);
+            check += static_cast<uint16_t>(out[c % FRAME_SAMPLES]);
+        }
+        auto t2 = std::chrono::steady_clock::now();
+        encSec += std::chrono::duration<double>(t1 - t0).count();
+        decSec += std::chrono::duration<double>(t2 - t1).count();
+    }
+
+    double audio = static_cast<double>(channels) * seconds;
+    std::cout << std::setprecision(0) << "throughput: " << channels << " channels x " << seconds
+              << " s, state " << sizeof(G722Encoder) << " + " << sizeof(G722Decoder) << " bytes" << std::endl;
+    std::cout << "  encode: " << std::setw(6) << audio / encSec << " channels/core, "
+              << std::setprecision(2) << encSec * 1e9 / (channels * ticks) / 1000 << " us/frame" << std::endl;
+    std::cout << std::setprecision(0) << "  decode: " << std::setw(6) << audio / decSec << " channels/core, "
+              << std::setprecision(2) << decSec * 1e9 / (channels * ticks) / 1000 << " us/frame" << std::endl;
+    std::cout << std::setprecision(0) << "  duplex: " << std::setw(6) << audio / (encSec + decSec)
+              << " channels/core (checksum " << check % 1000 << ")" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    int channels = argc > 1 ? atoi(argv[1]) : 256;
+    int seconds = argc > 2 ? atoi(argv[2]) : 10;
+
+    bool ok = validate();
+    throughput(channels, seconds);
+
+    return ok ? 0 : 1;
+}
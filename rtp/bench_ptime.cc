@@ -0,0 +1,161 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "fec.h"
+#include "ptime.h"
+#include "rtp_packet.h"
+
+/*
+不同 ptime 的包速率、线路字节数和 CPU：
+每路 10ms 一块采集 L16 @ 8kHz -> PtimeAggregator -> RTP -> UDP 回环 -> FecPlayout 拆成 10ms 播放帧，
+检查收到的样本与发送的一致。不按实时节奏，尽快跑完 STREAMS 路 x SECONDS 秒音频，
+CPU 用进程 CPU 时间 (含内核里的 UDP 收发) 折算成每路每秒。
+线路字节数按 IPv4 + UDP + RTP 头 (20 + 8 + 12) 计，不含链路层。
+用法: bench_ptime [路数] [秒数]
+*/
+
+#define SAMPLE_RATE 8000
+#define CAPTURE_SAMPLES 80 // 10ms 采集块
+#define WIRE_OVERHEAD (20 + 8 + RTP_HEADER_SIZE)
+#define MEDIA_PT 0
+
+struct Result {
+    double packetsPerSec;
+    double bitsPerSec;
+    double headerShare; // 实际发出的字节里包头 (IP+UDP+RTP) 的比例
+    double cpuUsPerSec;
+    bool intact;
+};
+
+static double cpuSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int16_t sample(int stream, uint32_t n) { return static_cast<int16_t>((n * 7 + stream * 131) & 0x7fff); }
+
+static Result run(unsigned ptime, int streams, int seconds, int tx, int rx, const sockaddr_in &dest) {
+    std::vector<PtimeAggregator> aggregators;
+    std::vector<FecPlayout> playouts;
+    std::vector<uint32_t> played(streams, 0);
+    for (int s = 0; s < streams; ++s) {
+        aggregators.emplace_back(ptime, SAMPLE_RATE, sizeof(int16_t));
+        playouts.emplace_back(0x7f, 0x7f, CAPTURE_SAMPLES, sizeof(int16_t));
+    }
+
+    int16_t capture[CAPTURE_SAMPLES];
+    uint8_t packet[RTP_MAX_PACKET];
+    uint8_t in[RTP_MAX_PACKET];
+    std::vector<uint8_t> frame;
+    uint64_t packets = 0, wireBytes = 0;
+    bool intact = true;
+    int chunks = seconds * 1000 / PTIME_FRAME_MS;
+
+    double cpu0 = cpuSeconds();
+    for (int c = 0; c < chunks; ++c) {
+        for (int s = 0; s < streams; ++s) {
+            for (int i = 0; i < CAPTURE_SAMPLES; ++i) {
+                capture[i] = sample(s, c * CAPTURE_SAMPLES + i);
+            }
+            PtimeAggregator &agg = aggregators[s];
+            agg.push(reinterpret_cast<const uint8_t *>(capture), sizeof(capture));
+
+            const uint8_t *payload;
+            size_t len;
+            uint32_t ts;
+            while (agg.pop(&payload, &len, &ts)) {
+                RtpHeader h;
+                h.payloadType = MEDIA_PT;
+                h.seq = static_cast<uint16_t>(packets);
+                h.timestamp = ts;
+                h.ssrc = s;
+                size_t n = rtpBuildPacket(packet, sizeof(packet), h, payload, len);
+                sendto(tx, packet, n, 0, reinterpret_cast<const sockaddr *>(&dest), sizeof(dest));
+                ++packets;
+                wireBytes += n - RTP_HEADER_SIZE + WIRE_OVERHEAD;
+
+                ssize_t r = recv(rx, in, sizeof(in), 0);
+                RtpHeader rh;
+                if (r <= 0 || rtpParseHeader(in, r, rh) == 0 || rh.ssrc >= static_cast<uint32_t>(streams)) {
+                    intact = false;
+                    continue;
+                }
+                FecPlayout &playout = playouts[rh.ssrc];
+                playout.input(in, r);
+                bool concealed;
+                while (playout.pop(frame, &concealed)) {
+                    const int16_t *pcm = reinterpret_cast<const int16_t *>(frame.data());
+                    if (concealed || frame.size() != sizeof(capture)) {
+                        intact = false;
+                        continue;
+                    }
+                    uint32_t &p = played[rh.ssrc];
+                    for (int i = 0; i < CAPTURE_SAMPLES; ++i) {
+                        intact = intact && pcm[i] == sample(rh.ssrc, p + i);
+                    }
+                    p += CAPTURE_SAMPLES;
+                }
+            }
+        }
+    }
+    double cpu = cpuSeconds() - cpu0;
+
+    double audio = static_cast<double>(streams) * seconds;
+    Result r;
+    r.packetsPerSec = packets / audio;
+    r.bitsPerSec = wireBytes * 8 / audio;
+    // 按实际发出的负载算，不用标称码率：留在聚合器里的样本没有发出
+    r.headerShare = wireBytes ? static_cast<double>(packets * WIRE_OVERHEAD) / wireBytes : 0.0;
+    r.cpuUsPerSec = cpu * 1e6 / audio;
+    for (int s = 0; s < streams; ++s) {
+        // 最后不满一个 ptime 的样本留在聚合器里
+        size_t sent = static_cast<size_t>(chunks) * CAPTURE_SAMPLES;
+        intact = intact && played[s] + aggregators[s].pendingSamples() == sent;
+    }
+    r.intact = intact;
+    return r;
+}
+
+int main(int argc, char *argv[]) {
+    int streams = argc > 1 ? atoi(argv[1]) : 100;
+    int seconds = argc > 2 ? atoi(argv[2]) : 10;
+
+    int tx = socket(AF_INET, SOCK_DGRAM, 0);
+    int rx = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t alen = sizeof(addr);
+    if (tx < 0 || rx < 0 || bind(rx, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 ||
+        getsockname(rx, reinterpret_cast<sockaddr *>(&addr), &alen) < 0) {
+        perror("socket");
+        return 1;
+    }
+
+    std::cout << streams << " streams x " << seconds << " s, L16 @ 8 kHz, 10 ms capture, UDP loopback" << std::endl;
+    std::cout << "ptime   pkt/s   kbit/s on wire   header share   CPU us per stream-second   streams/core" << std::endl;
+    bool ok = true;
+    for (unsigned ptime : {10u, 20u, 40u, 60u}) {
+        Result r = run(ptime, streams, seconds, tx, rx, addr);
+        ok = ok && r.intact;
+        std::cout << std::fixed << std::setprecision(0) << std::setw(3) << ptime << " ms" << std::setw(8)
+                  << r.packetsPerSec << std::setprecision(1) << std::setw(17) << r.bitsPerSec / 1000
+                  << std::setw(14) << 100 * r.headerShare << "%" << std::setprecision(0)
+                  << std::setw(27) << r.cpuUsPerSec << std::setw(15) << 1e6 / r.cpuUsPerSec
+                  << (r.intact ? "" : "  DATA MISMATCH") << std::endl;
+    }
+
+    close(tx);
+    close(rx);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,97 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+#include <arpa/inet.h>
+
+#include "session_pool.h"
+
+using namespace jrtplib;
+
+/*
+呼叫建立/拆除压测：
+- pool:   SessionPool::acquire + 发一个包 + release (异步 BYE)，
+          持续速率受 回收线程数 / BYE 等待时间 限制
+- direct: 每个呼叫 Create + 发一个包 + BYEDestroy，和现有各个 main 的做法相同
+输出持续的呼叫速率和建立时延分位数。
+用法: bench_session_pool [呼叫数] [池大小]
+*/
+
+#define SAMPLE_RATE 8000
+#define PORT_BASE 20000
+#define DIRECT_PORT 40000
+#define DEST_IP "127.0.0.1"
+#define DEST_PORT 9000
+#define PAYLOAD_SIZE 320
+#define RECLAIM_THREADS 16
+
+typedef std::chrono::steady_clock Clock;
+
+static double usSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+static void report(const char *name, std::vector<double> &setupUs, double totalSec) {
+    std::sort(setupUs.begin(), setupUs.end());
+    size_t n = setupUs.size();
+    std::cout << name << ": " << n << " calls in " << totalSec << " s, "
+              << n / totalSec << " calls/s, setup p50=" << setupUs[n / 2]
+              << "us p99=" << setupUs[n * 99 / 100] << "us max=" << setupUs[n - 1] << "us" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    int calls = argc > 1 ? atoi(argv[1]) : 10000;
+    int poolSize = argc > 2 ? atoi(argv[2]) : 256;
+    uint32_t dest = ntohl(inet_addr(DEST_IP));
+    uint8_t payload[PAYLOAD_SIZE] = {0};
+
+    SessionPool pool(PORT_BASE, poolSize, 1.0 / SAMPLE_RATE, RECLAIM_THREADS);
+    auto start = Clock::now();
+    if (pool.init() < 0) {
+        std::cerr << "SessionPool init failed" << std::endl;
+        return 1;
+    }
+    std::cout << "pool of " << poolSize << " sessions bound in " << usSince(start) / 1000 << " ms" << std::endl;
+
+    std::vector<double> setupUs;
+    setupUs.reserve(calls);
+    start = Clock::now();
+    for (int i = 0; i < calls; ++i) {
+        auto t = Clock::now();
+        PooledSession *call;
+        while ((call = pool.acquire(dest, DEST_PORT)) == nullptr) {
+            std::this_thread::yield(); // 池耗尽时等待后台回收
+        }
+        setupUs.push_back(usSince(t));
+        call->session.SendPacket(payload, sizeof(payload), 0, false, 160);
+        pool.release(call);
+    }
+    report("pool", setupUs, usSince(start) / 1e6);
+    pool.stop();
+
+    // 同步方式代价很高，只跑少量呼叫
+    int directCalls = std::min(calls, 200);
+    setupUs.clear();
+    start = Clock::now();
+    for (int i = 0; i < directCalls; ++i) {
+        auto t = Clock::now();
+        RTPSession sess;
+        RTPSessionParams sessparams;
+        sessparams.SetOwnTimestampUnit(1.0 / SAMPLE_RATE);
+        RTPUDPv4TransmissionParams transparams;
+        transparams.SetPortbase(DIRECT_PORT);
+        if (sess.Create(sessparams, &transparams) < 0) {
+            std::cerr << "Error creating RTP session!" << std::endl;
+            return 1;
+        }
+        sess.AddDestination(RTPIPv4Address(dest, DEST_PORT));
+        setupUs.push_back(usSince(t));
+        sess.SendPacket(payload, sizeof(payload), 0, false, 160);
+        sess.BYEDestroy(RTPTime(10, 0), "Session ended", 14);
+    }
+    report("direct", setupUs, usSince(start) / 1e6);
+
+    return 0;
+}
@@ -0,0 +1,139 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <vector>
+
+#include "signal_gen.h"
+
+/*
+信号发生器吞吐：按 160 样本 (8kHz 20ms) 一块生成，和 pa/main.cc 原来每样本 std::sin 的写法对比。
+"streams/core" = 每秒样本数 / 8000，即单核能实时驱动多少路。
+另外给出振荡器/扫频相对 double 精度参考的最大误差。
+用法: bench_siggen [块数]
+*/
+
+#define SAMPLE_RATE 8000
+#define BLOCK 160
+
+static double elapsedSec(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static float sink = 0;
+
+static void report(const char *name, double seconds, size_t samples, double baseline) {
+    double rate = samples / seconds;
+    std::cout << std::left << std::setw(20) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << rate / 1e6 << " Msamples/s" << std::setw(10) << rate / SAMPLE_RATE
+              << " streams/core" << std::setw(8) << (baseline > 0 ? rate / baseline : 1.0) << "x" << std::endl;
+}
+
+template <typename G>
+static double run(G &gen, int blocks) {
+    float out[BLOCK];
+    auto start = std::chrono::steady_clock::now();
+    for (int b = 0; b < blocks; ++b) {
+        gen.generate(out, BLOCK);
+        sink += out[b % BLOCK];
+    }
+    return elapsedSec(start);
+}
+
+// 原 playCallback 的写法
+static double runStdSin(int blocks) {
+    float out[BLOCK];
+    float phase = 0;
+    const float step = 2 * M_PI * 440.0f / SAMPLE_RATE;
+    auto start = std::chrono::steady_clock::now();
+    for (int b = 0; b < blocks; ++b) {
+        for (int i = 0; i < BLOCK; ++i) {
+            out[i] = std::sin(phase) * 0.3f;
+            phase += step;
+            if (phase >= 2 * M_PI) {
+                phase -= 2 * M_PI;
+            }
+        }
+        sink += out[b % BLOCK];
+    }
+    return elapsedSec(start);
+}
+
+// 1 小时信号与 double 参考的最大误差
+static void accuracy() {
+    const size_t n = SAMPLE_RATE * 3600;
+    std::vector<float> out(n);
+
+    Oscillator osc(1013.0, SAMPLE_RATE, 1.0f);
+    osc.generate(out.data(), n);
+    double maxErr = 0;
+    for (size_t i = 0; i < n; ++i) {
+        double ref = std::sin(2 * M_PI * 1013.0 * static_cast<double>(i) / SAMPLE_RATE);
+        maxErr = std::max(maxErr, std::fabs(out[i] - ref));
+    }
+    std::cout << "oscillator max error over 1 h: " << std::scientific << std::setprecision(2) << maxErr << std::endl;
+
+    // 扫频每 1 秒重新开始，取一个周期比较
+    Sweep sweep(300.0, 3400.0, 1.0, SAMPLE_RATE, 1.0f);
+    sweep.generate(out.data(), SAMPLE_RATE);
+    double k = 3100.0;
+    maxErr = 0;
+    for (size_t i = 0; i < SAMPLE_RATE; ++i) {
+        double t = static_cast<double>(i) / SAMPLE_RATE;
+        double ref = std::sin(2 * M_PI * (300.0 * t + 0.5 * k * t * t));
+        maxErr = std::max(maxErr, std::fabs(out[i] - ref));
+    }
+    std::cout << "sweep max error over 1 s:      " << maxErr << std::endl;
+
+    PinkNoise pink(1.0f, 7);
+    pink.generate(out.data(), n);
+    double peak = 0;
+    double power = 0;
+    for (size_t i = 0; i < n; ++i) {
+        peak = std::max(peak, static_cast<double>(std::fabs(out[i])));
+        power += static_cast<double>(out[i]) * out[i];
+    }
+    std::cout << "pink noise peak " << std::fixed << std::setprecision(3) << peak
+              << ", rms " << std::sqrt(power / n) << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    int blocks = argc > 1 ? atoi(argv[1]) : 500000;
+    size_t samples = static_cast<size_t>(blocks) * BLOCK;
+
+    double t = runStdSin(blocks);
+    double baseline = samples / t;
+    report("std::sin loop", t, samples, 0);
+
+    Oscillator osc(440.0, SAMPLE_RATE, 0.3f);
+    report("oscillator", run(osc, blocks), samples, baseline);
+
+    DtmfGenerator dtmf(SAMPLE_RATE, 100, 0);
+    const char digits[] = "0123456789*#ABCD";
+    dtmf.start(digits);
+    float out[BLOCK];
+    auto start = std::chrono::steady_clock::now();
+    for (int b = 0; b < blocks; ++b) {
+        if (dtmf.done()) {
+            dtmf.start(digits);
+        }
+        dtmf.generate(out, BLOCK);
+        sink += out[b % BLOCK];
+    }
+    report("dtmf (2 tones)", elapsedSec(start), samples, baseline);
+
+    Sweep sweep(300.0, 3400.0, 1.0, SAMPLE_RATE, 0.3f);
+    report("sweep", run(sweep, blocks), samples, baseline);
+
+    WhiteNoise white(0.1f);
+    report("white noise", run(white, blocks), samples, baseline);
+
+    PinkNoise pink(0.1f);
+    report("pink noise", run(pink, blocks), samples, baseline);
+
+    accuracy();
+    std::cout << "(checksum " << sink << ")" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <unordered_map>
+
+#include "ssrc_map.h"
+
+// 与 demux.cc 中 SourceState 大小相同的统计状态
+struct BenchState {
+    uint32_t baseSeq;
+    uint32_t maxSeq;
+    uint32_t received;
+    int32_t transit;
+    uint32_t jitter;
+
+    BenchState() : baseSeq(0), maxSeq(0), received(0), transit(0), jitter(0) {}
+};
+
+#define NUM_SOURCES 100000
+#define NUM_LOOKUPS 10000000
+
+static double elapsedNs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    std::mt19937 rng(12345);
+    std::vector<uint32_t> ssrcs(NUM_SOURCES);
+    for (auto &s : ssrcs) {
+        s = rng();
+    }
+    // 按包到达顺序随机访问
+    std::vector<uint32_t> order(NUM_LOOKUPS);
+    for (auto &o : order) {
+        o = ssrcs[rng() % NUM_SOURCES];
+    }
+
+    SsrcMap<BenchState> map(NUM_SOURCES);
+    SsrcMap<BenchState>::Result result;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t s : ssrcs) {
+        map.lookup(s, 0x7f000001, 9000, 0, &result);
+    }
+    double insertNs = elapsedNs(start) / NUM_SOURCES;
+
+    uint64_t sink = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint32_t s : order) {
+        BenchState *st = map.lookup(s, 0x7f000001, 9000, 1, &result);
+        sink += ++st->received;
+    }
+    double lookupNs = elapsedNs(start) / NUM_LOOKUPS;
+
+    std::unordered_map<uint32_t, BenchState> ref;
+    ref.reserve(NUM_SOURCES);
+    for (uint32_t s : ssrcs) {
+        ref[s];
+    }
+    start = std::chrono::steady_clock::now();
+    for (uint32_t s : order) {
+        sink += ++ref[s].received;
+    }
+    double refNs = elapsedNs(start) / NUM_LOOKUPS;
+
+    // 一半的源超时
+    for (size_t i = 0; i < ssrcs.size(); i += 2) {
+        map.lookup(ssrcs[i], 0x7f000001, 9000, 10000, &result);
+    }
+    start = std::chrono::steady_clock::now();
+    size_t evicted = map.evictIdle(10000, 5000);
+    double evictMs = elapsedNs(start) / 1e6;
+
+    std::cout << "sources:              " << NUM_SOURCES << std::endl;
+    std::cout << "slot size:            " << sizeof(SsrcMap<BenchState>::Slot) << " bytes" << std::endl;
+    std::cout << "table capacity:       " << map.capacity() << " slots" << std::endl;
+    std::cout << "memory per source:    " << map.memoryBytes() / NUM_SOURCES << " bytes" << std::endl;
+    std::cout << "insert:               " << insertNs << " ns/op" << std::endl;
+    std::cout << "lookup (SsrcMap):     " << lookupNs << " ns/op" << std::endl;
+    std::cout << "lookup (unordered_map): " << refNs << " ns/op" << std::endl;
+    std::cout << "evictIdle:            " << evicted << " sources in " << evictMs << " ms" << std::endl;
+    std::cout << "(checksum " << sink << ")" << std::endl;
+
+    return 0;
+}
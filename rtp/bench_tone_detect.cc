@@ -0,0 +1,297 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+#include "rtp_packet.h"
+#include "signal_gen.h"
+#include "tone_detect.h"
+
+/*
+ToneDetectorBank 验证和吞吐：
+1. Q.24 验证：每个试验占一路呼叫，一次跑 TRIALS 路。
+   按键时长 (≥40ms 必须检测，≤20ms 必须拒绝)、键间停顿 (≥40ms 必须分开，≤10ms 不能拆开)、
+   twist、电平、噪声、以及纯噪声下的误检；
+2. RFC 4733：把一次按键转成 telephone-event RTP 包，并和手工推出的包字节逐字节比较；
+3. 吞吐：STREAMS 路呼叫，每 20ms 每路一帧，统计单核能实时处理多少路。
+用法: bench_tone_detect [呼叫数] [秒数]
+*/
+
+#define SAMPLE_RATE 8000
+#define FRAME 160
+#define TRIALS 200
+#define EVENT_PT 101
+
+struct Segment {
+    double lowDb;   // 低频组电平 (dBov)，静音时无效
+    double highDb;
+    double ms;
+    bool tone;
+};
+
+// 生成 '5' (770 + 1336 Hz) 的按键序列，前面加 lead 个静音样本，后面补 200ms 静音
+static std::vector<int16_t> render(const std::vector<Segment> &segs, size_t lead, double noiseDbov, uint32_t seed) {
+    std::vector<float> out(lead, 0.0f);
+    for (const Segment &s : segs) {
+        size_t n = static_cast<size_t>(s.ms * SAMPLE_RATE / 1000);
+        size_t base = out.size();
+        out.resize(base + n, 0.0f);
+        if (s.tone) {
+            MultiTone t(SAMPLE_RATE);
+            t.addTone(770, sigDbovToAmplitude(s.lowDb));
+            t.addTone(1336, sigDbovToAmplitude(s.highDb));
+            t.generate(out.data() + base, n);
+        }
+    }
+    out.resize(out.size() + SAMPLE_RATE / 5, 0.0f);
+    out.resize((out.size() + FRAME - 1) / FRAME * FRAME, 0.0f);
+    if (noiseDbov > -100) {
+        std::vector<float> noise(out.size());
+        PinkNoise pink(sigDbovToAmplitude(noiseDbov), seed);
+        pink.generate(noise.data(), noise.size());
+        for (size_t i = 0; i < out.size(); ++i) {
+            out[i] += noise[i];
+        }
+    }
+    std::vector<int16_t> pcm(out.size());
+    sigToPcm16(out.data(), pcm.data(), out.size());
+    return pcm;
+}
+
+// 每路跑自己的信号，返回每路检测到的按键 (开始事件) 数
+static std::vector<int> detect(ToneDetectorBank &bank, const std::vector<std::vector<int16_t>> &signals,
+                               std::vector<ToneEvent> *all = nullptr) {
+    size_t longest = 0;
+    for (size_t s = 0; s < signals.size(); ++s) {
+        bank.open(s);
+        longest = std::max(longest, signals[s].size());
+    }
+    std::vector<int> digits(signals.size(), 0);
+    std::vector<const int16_t *> frames(bank.capacity(), nullptr);
+    std::vector<ToneEvent> events;
+    for (size_t off = 0; off < longest; off += FRAME) {
+        for (size_t s = 0; s < signals.size(); ++s) {
+            frames[s] = off < signals[s].size() ? signals[s].data() + off : nullptr;
+        }
+        events.clear();
+        bank.process(frames.data(), FRAME, events);
+        for (const ToneEvent &e : events) {
+            if (!e.end && e.event < 16) {
+                ++digits[e.stream];
+            }
+            if (all) {
+                all->push_back(e);
+            }
+        }
+    }
+    // 送一段静音让最后的按键结束
+    std::fill(frames.begin(), frames.end(), nullptr);
+    for (int k = 0; k < 10; ++k) {
+        events.clear();
+        bank.process(frames.data(), FRAME, events);
+        if (all) {
+            all->insert(all->end(), events.begin(), events.end());
+        }
+    }
+    for (size_t s = 0; s < signals.size(); ++s) {
+        bank.close(s);
+    }
+    return digits;
+}
+
+// TRIALS 个随机对齐的试验，返回检测到 expected 个按键的比例
+static double rate(const std::vector<Segment> &segs, int expected, double noiseDbov, std::mt19937 &rng) {
+    ToneDetectorBank bank(TRIALS);
+    std::vector<std::vector<int16_t>> signals;
+    for (int t = 0; t < TRIALS; ++t) {
+        signals.push_back(render(segs, rng() % TONE_BLOCK + FRAME, noiseDbov, t + 1));
+    }
+    std::vector<int> digits = detect(bank, signals);
+    int ok = 0;
+    for (int d : digits) {
+        ok += d == expected;
+    }
+    return 100.0 * ok / TRIALS;
+}
+
+static void validate() {
+    std::mt19937 rng(1);
+    std::cout << std::fixed << std::setprecision(0);
+
+    std::cout << "tone duration (-10 dBov, Q.24: accept >= 40 ms, reject <= 20 ms)" << std::endl;
+    for (double ms : {15.0, 20.0, 23.0, 30.0, 35.0, 40.0, 50.0, 100.0}) {
+        std::cout << "  " << std::setw(4) << ms << " ms: detected in "
+                  << std::setw(3) << rate({{-10, -10, ms, true}}, 1, -200, rng) << "% of trials" << std::endl;
+    }
+
+    std::cout << "pause between two 60 ms digits (Q.24: >= 40 ms gives 2 digits, <= 10 ms gives 1)" << std::endl;
+    for (double gap : {5.0, 10.0, 20.0, 30.0, 40.0, 60.0}) {
+        std::vector<Segment> segs = {{-10, -10, 60, true}, {0, 0, gap, false}, {-10, -10, 60, true}};
+        std::cout << "  " << std::setw(4) << gap << " ms: 1 digit " << std::setw(3) << rate(segs, 1, -200, rng)
+                  << "%, 2 digits " << std::setw(3) << rate(segs, 2, -200, rng) << "%" << std::endl;
+    }
+
+    std::cout << "twist, high - low group (accept -" << DTMF_TWIST_LOW_DB << " .. +" << DTMF_TWIST_HIGH_DB
+              << " dB)" << std::endl;
+    for (double twist : {-12.0, -10.0, -8.0, -6.0, -2.0, 0.0, 2.0, 4.0, 6.0, 8.0}) {
+        std::cout << "  " << std::setw(4) << twist << " dB: detected in "
+                  << std::setw(3) << rate({{-12 - twist / 2, -12 + twist / 2, 60, true}}, 1, -200, rng)
+                  << "%" << std::endl;
+    }
+
+    std::cout << "level per tone (minimum " << DTMF_MIN_LEVEL_DBOV << " dBov)" << std::endl;
+    for (double level : {-45.0, -40.0, -35.0, -30.0, -20.0, -3.0}) {
+        std::cout << "  " << std::setw(4) << level << " dBov: detected in "
+                  << std::setw(3) << rate({{level, level, 60, true}}, 1, -200, rng) << "%" << std::endl;
+    }
+
+    std::cout << "pink noise at -30 dBov, tones at -20 dBov" << std::endl;
+    std::cout << "  60 ms digit: detected in " << rate({{-20, -20, 60, true}}, 1, -30, rng) << "%" << std::endl;
+
+    // 误检：TRIALS 路各 10 秒 -15 dBov 粉红噪声
+    ToneDetectorBank bank(TRIALS);
+    std::vector<std::vector<int16_t>> signals;
+    for (int t = 0; t < TRIALS; ++t) {
+        signals.push_back(render({{0, 0, 10000, false}}, 0, -15, 1000 + t));
+    }
+    int falseDigits = 0;
+    for (int d : detect(bank, signals)) {
+        falseDigits += d;
+    }
+    std::cout << "false detections in " << TRIALS * 10 << " s of pink noise: " << falseDigits << std::endl;
+}
+
+// 一路呼叫的按键经 TelephoneEventStream 转成 RTP 包：首包、每 50ms 更新、3 个结束包
+static void telephoneEvents() {
+    std::vector<int16_t> signal = render({{-10, -10, 120, true}}, FRAME, -200, 1);
+    ToneDetectorBank bank(1);
+    bank.open(0);
+    TelephoneEventStream stream(EVENT_PT, 0x1234);
+    std::vector<ToneEvent> events;
+    std::vector<TelephoneEventRtp> packets;
+    for (size_t off = 0; off + FRAME <= signal.size(); off += FRAME) {
+        const int16_t *frame = signal.data() + off;
+        bank.process(&frame, FRAME, events);
+        for (const ToneEvent &e : events) {
+            stream.onEvent(e, packets);
+        }
+        events.clear();
+        stream.advance(bank.now(), packets);
+    }
+
+    std::cout << "RFC 4733 packets for a 120 ms '5':" << std::endl;
+    for (const TelephoneEventRtp &p : packets) {
+        RtpHeader h;
+        size_t off = rtpParseHeader(p.bytes, sizeof(p.bytes), h);
+        uint8_t event, volume;
+        bool end;
+        uint16_t duration;
+        rfc4733Read(p.bytes + off, sizeof(p.bytes) - off, &event, &end, &volume, &duration);
+        std::cout << "  M=" << h.marker << " seq=" << h.seq << " ts=" << h.timestamp << " event="
+                  << dtmfEventDigit(event) << " E=" << end << " volume=-" << static_cast<int>(volume)
+                  << " dBm0 duration=" << duration << std::endl;
+    }
+}
+
+// 手工推出的包字节：序列号和时间戳都跨过回绕
+static bool telephoneEventBytes() {
+    TelephoneEventStream stream(EVENT_PT, 0x11223344, 0xfffe, 0xfffff000);
+    std::vector<TelephoneEventRtp> packets;
+    ToneEvent down = {0, 5, false, 5000, 200, 10};
+    ToneEvent up = {0, 5, true, 5000, 1100, 10};
+    stream.onEvent(down, packets);   // 在 5200 检测到，持续 200
+    stream.advance(5360, packets);   // 不到 400 个样本，不发
+    stream.advance(5600, packets);   // 更新，持续 600
+    stream.advance(6000, packets);   // 更新，持续 1000
+    stream.onEvent(up, packets);     // 结束，持续 1100，发 3 次
+    stream.advance(6400, packets);   // 已结束，不发
+
+    // ts = 0xfffff000 + 5000 = 0x00000388
+    static const uint8_t expected[][RFC4733_PACKET_SIZE] = {
+        {0x80, 0xe5, 0xff, 0xfe, 0x00, 0x00, 0x03, 0x88, 0x11, 0x22, 0x33, 0x44, 0x05, 0x0a, 0x00, 0xc8},
+        {0x80, 0x65, 0xff, 0xff, 0x00, 0x00, 0x03, 0x88, 0x11, 0x22, 0x33, 0x44, 0x05, 0x0a, 0x02, 0x58},
+        {0x80, 0x65, 0x00, 0x00, 0x00, 0x00, 0x03, 0x88, 0x11, 0x22, 0x33, 0x44, 0x05, 0x0a, 0x03, 0xe8},
+        {0x80, 0x65, 0x00, 0x01, 0x00, 0x00, 0x03, 0x88, 0x11, 0x22, 0x33, 0x44, 0x05, 0x8a, 0x04, 0x4c},
+        {0x80, 0x65, 0x00, 0x02, 0x00, 0x00, 0x03, 0x88, 0x11, 0x22, 0x33, 0x44, 0x05, 0x8a, 0x04, 0x4c},
+        {0x80, 0x65, 0x00, 0x03, 0x00, 0x00, 0x03, 0x88, 0x11, 0x22, 0x33, 0x44, 0x05, 0x8a, 0x04, 0x4c},
+    };
+    const size_t count = sizeof(expected) / sizeof(expected[0]);
+    bool ok = packets.size() == count;
+    for (size_t i = 0; ok && i < count; ++i) {
+        if (memcmp(packets[i].bytes, expected[i], RFC4733_PACKET_SIZE) != 0) {
+            std::cout << "  packet " << i << " differs" << std::endl;
+            ok = false;
+        }
+    }
+    std::cout << "RFC 4733 packet bytes: " << packets.size() << " packets -> " << (ok ? "ok" : "FAILED")
+              << std::endl;
+    return ok;
+}
+
+static void throughput(int streams, int seconds) {
+    // 64 种信号循环使用：按键、应答音、噪声
+    const int patterns = 64;
+    std::vector<std::vector<int16_t>> signals;
+    for (int p = 0; p < patterns; ++p) {
+        std::vector<float> out(SAMPLE_RATE * 2);
+        if (p % 4 == 0) {
+            DtmfGenerator dtmf(SAMPLE_RATE, 80, 80, -12);
+            dtmf.start("0123456789*#");
+            dtmf.generate(out.data(), out.size());
+        } else if (p % 4 == 1) {
+            Oscillator ans(2100, SAMPLE_RATE, 0.2f);
+            ans.generate(out.data(), out.size());
+        } else {
+            PinkNoise pink(0.1f, p);
+            pink.generate(out.data(), out.size());
+        }
+        std::vector<int16_t> pcm(out.size());
+        sigToPcm16(out.data(), pcm.data(), out.size());
+        signals.push_back(pcm);
+    }
+
+    ToneDetectorBank bank(streams);
+    bank.addTone(2100, 400, RFC4733_EVENT_ANS);
+    bank.addTone(1100, 400, RFC4733_EVENT_CNG);
+    for (int s = 0; s < streams; ++s) {
+        bank.open(s);
+    }
+
+    std::vector<const int16_t *> frames(streams);
+    std::vector<ToneEvent> events;
+    size_t frameCount = signals[0].size() / FRAME;
+    int ticks = seconds * SAMPLE_RATE / FRAME;
+    size_t total = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < ticks; ++t) {
+        for (int s = 0; s < streams; ++s) {
+            frames[s] = signals[s % patterns].data() + ((t + s) % frameCount) * FRAME;
+        }
+        events.clear();
+        bank.process(frames.data(), FRAME, events);
+        total += events.size();
+    }
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "throughput: " << streams << " streams x " << seconds << " s audio, 10 Goertzel filters, "
+              << TONE_LANES << " lanes: " << std::setprecision(3) << sec << " s -> "
+              << std::setprecision(0) << streams * seconds / sec << " streams/core ("
+              << total << " events)" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    int streams = argc > 1 ? atoi(argv[1]) : 4096;
+    int seconds = argc > 2 ? atoi(argv[2]) : 10;
+
+    validate();
+    telephoneEvents();
+    bool ok = telephoneEventBytes();
+    throughput(streams, seconds);
+
+    return ok ? 0 : 1;
+}
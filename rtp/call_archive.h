@@ -0,0 +1,433 @@
+#ifndef RTP_CALL_ARCHIVE_H
+#define RTP_CALL_ARCHIVE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+多通呼叫共用的分段录音归档，替代每个进程一个 output.pcm。
+
+目录结构：
+  segment-000001.seg ...  预分配的只追加段文件，所有呼叫的记录交错写入
+  index.dat               每通呼叫结束时追加它的时间索引
+
+段文件：64 字节段头 + 记录。记录 = 24 字节记录头 + 负载，按 8 字节对齐。
+写入端按原子偏移预留空间后直接 memcpy 到 mmap 的段中，多线程写入只在换段时加锁。
+每条记录在该呼叫的索引里占 12 字节 (相对时间 ms、段号、段内偏移)，
+读取端 mmap 段和索引，按时间二分查找 (O(log n))，返回的负载直接指向映射内存，不拷贝。
+呼叫必须 closeCall() 之后索引才会落盘，进程崩溃时未关闭呼叫的记录只能靠扫描段文件找回。
+*/
+
+#define ARCHIVE_MAGIC "RTPARCH1"
+#define ARCHIVE_VERSION 1
+#define ARCHIVE_SEGMENT_HEADER 64
+#define ARCHIVE_DEFAULT_SEGMENT (256u << 20)
+#define ARCHIVE_INDEX_SHARDS 64
+
+enum ArchiveRecordKind {
+    ARCHIVE_RTP = 1,  // 完整 RTP 包
+    ARCHIVE_PCM = 2   // 解码后的帧
+};
+
+struct ArchiveRecordHeader {
+    uint32_t length;  // 负载长度
+    uint16_t kind;
+    uint16_t flags;
+    uint64_t callId;
+    uint64_t timeNs;
+};
+
+struct ArchiveIndexEntry {
+    uint32_t relMs;   // 相对呼叫第一条记录的时间
+    uint32_t segment;
+    uint32_t offset;
+};
+
+struct ArchiveIndexHeader {
+    uint64_t callId;
+    uint64_t startNs;
+    uint32_t count;
+    uint32_t reserved;
+};
+
+inline std::string archiveSegmentPath(const std::string &dir, uint32_t id) {
+    char name[32];
+    snprintf(name, sizeof(name), "/segment-%06u.seg", id);
+    return dir + name;
+}
+
+class ArchiveWriter {
+public:
+    explicit ArchiveWriter(const std::string &dir, size_t segmentBytes = ARCHIVE_DEFAULT_SEGMENT) :
+        dir(dir), segmentBytes(segmentBytes), indexFd(-1), current(nullptr) {}
+
+    ~ArchiveWriter() {
+        for (auto &shard : shards) {
+            std::vector<uint64_t> ids;
+            for (auto &kv : shard.calls) {
+                ids.push_back(kv.first);
+            }
+            for (uint64_t id : ids) {
+                closeCall(id);
+            }
+        }
+        for (auto &seg : segments) {
+            munmap(seg->base, seg->size);
+            close(seg->fd);
+        }
+        if (indexFd >= 0) {
+            close(indexFd);
+        }
+    }
+
+    ArchiveWriter(const ArchiveWriter &) = delete;
+    ArchiveWriter &operator=(const ArchiveWriter &) = delete;
+
+    bool open() {
+        if (mkdir(dir.c_str(), 0755) < 0 && errno != EEXIST) {
+            return false;
+        }
+        indexFd = ::open((dir + "/index.dat").c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (indexFd < 0) {
+            return false;
+        }
+        // 接着已有的段编号继续写
+        uint32_t id = 1;
+        while (access(archiveSegmentPath(dir, id).c_str(), F_OK) == 0) {
+            ++id;
+        }
+        nextSegmentId = id;
+        std::lock_guard<std::mutex> lock(rollMutex);
+        return rollSegment();
+    }
+
+    /**
+     * @brief 追加一条记录，线程安全.
+     * @return 段文件无法创建时返回 false.
+     */
+    bool append(uint64_t callId, uint64_t timeNs, uint16_t kind, const void *data, uint32_t len) {
+        size_t need = (sizeof(ArchiveRecordHeader) + len + 7) & ~static_cast<size_t>(7);
+        if (need > segmentBytes - ARCHIVE_SEGMENT_HEADER) {
+            return false;
+        }
+        Segment *seg;
+        size_t off;
+        while (true) {
+            seg = current.load(std::memory_order_acquire);
+            off = seg->used.fetch_add(need, std::memory_order_relaxed);
+            if (off + need <= seg->size) {
+                break;
+            }
+            std::lock_guard<std::mutex> lock(rollMutex);
+            if (current.load(std::memory_order_relaxed) == seg && !rollSegment()) {
+                return false;
+            }
+        }
+
+        uint8_t *p = seg->base + off;
+        ArchiveRecordHeader h;
+        h.length = len;
+        h.kind = kind;
+        h.flags = 0;
+        h.callId = callId;
+        h.timeNs = timeNs;
+        memcpy(p, &h, sizeof(h));
+        memcpy(p + sizeof(h), data, len);
+
+        Shard &shard = shards[callId % ARCHIVE_INDEX_SHARDS];
+        std::lock_guard<std::mutex> lock(shard.m);
+        CallIndex &ci = shard.calls[callId];
+        if (ci.entries.empty()) {
+            ci.startNs = timeNs;
+        }
+        ArchiveIndexEntry e;
+        e.relMs = timeNs > ci.startNs ? static_cast<uint32_t>((timeNs - ci.startNs) / 1000000) : 0;
+        e.segment = seg->id;
+        e.offset = static_cast<uint32_t>(off);
+        ci.entries.push_back(e);
+        return true;
+    }
+
+    // 呼叫结束：把它的索引按时间排序后追加到 index.dat
+    bool closeCall(uint64_t callId) {
+        CallIndex ci;
+        {
+            Shard &shard = shards[callId % ARCHIVE_INDEX_SHARDS];
+            std::lock_guard<std::mutex> lock(shard.m);
+            auto it = shard.calls.find(callId);
+            if (it == shard.calls.end()) {
+                return false;
+            }
+            ci.startNs = it->second.startNs;
+            ci.entries.swap(it->second.entries);
+            shard.calls.erase(it);
+        }
+        // 多线程写入同一呼叫时可能轻微乱序
+        std::stable_sort(ci.entries.begin(), ci.entries.end(),
+                         [](const ArchiveIndexEntry &a, const ArchiveIndexEntry &b) { return a.relMs < b.relMs; });
+
+        ArchiveIndexHeader h;
+        h.callId = callId;
+        h.startNs = ci.startNs;
+        h.count = static_cast<uint32_t>(ci.entries.size());
+        h.reserved = 0;
+        std::vector<uint8_t> buf(sizeof(h) + ci.entries.size() * sizeof(ArchiveIndexEntry));
+        memcpy(buf.data(), &h, sizeof(h));
+        memcpy(buf.data() + sizeof(h), ci.entries.data(), ci.entries.size() * sizeof(ArchiveIndexEntry));
+
+        std::lock_guard<std::mutex> lock(indexMutex);
+        return write(indexFd, buf.data(), buf.size()) == static_cast<ssize_t>(buf.size());
+    }
+
+private:
+    struct Segment {
+        uint32_t id;
+        int fd;
+        uint8_t *base;
+        size_t size;
+        std::atomic<size_t> used;
+    };
+
+    struct CallIndex {
+        uint64_t startNs = 0;
+        std::vector<ArchiveIndexEntry> entries;
+    };
+
+    struct Shard {
+        std::mutex m;
+        std::unordered_map<uint64_t, CallIndex> calls;
+    };
+
+    // 调用者持有 rollMutex；旧段保持映射，可能还有线程在往里拷贝
+    bool rollSegment() {
+        uint32_t id = nextSegmentId++;
+        int fd = ::open(archiveSegmentPath(dir, id).c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+        if (fd < 0) {
+            return false;
+        }
+        if (posix_fallocate(fd, 0, segmentBytes) != 0) {
+            close(fd);
+            return false;
+        }
+        void *base = mmap(nullptr, segmentBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (base == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        std::unique_ptr<Segment> seg(new Segment);
+        seg->id = id;
+        seg->fd = fd;
+        seg->base = static_cast<uint8_t *>(base);
+        seg->size = segmentBytes;
+        seg->used = ARCHIVE_SEGMENT_HEADER;
+
+        uint8_t *h = seg->base;
+        memcpy(h, ARCHIVE_MAGIC, 8);
+        uint32_t version = ARCHIVE_VERSION;
+        uint64_t size = segmentBytes;
+        memcpy(h + 8, &version, 4);
+        memcpy(h + 12, &id, 4);
+        memcpy(h + 16, &size, 8);
+
+        current.store(seg.get(), std::memory_order_release);
+        segments.push_back(std::move(seg));
+        return true;
+    }
+
+    std::string dir;
+    size_t segmentBytes;
+    int indexFd;
+    uint32_t nextSegmentId = 1;
+
+    std::atomic<Segment *> current;
+    std::vector<std::unique_ptr<Segment>> segments;
+    std::mutex rollMutex;
+
+    Shard shards[ARCHIVE_INDEX_SHARDS];
+    std::mutex indexMutex;
+};
+
+class ArchiveReader {
+public:
+    struct Record {
+        uint64_t callId;
+        uint64_t timeNs;
+        uint16_t kind;
+        const uint8_t *data; // 指向映射内存，ArchiveReader 析构前有效
+        uint32_t length;
+    };
+
+    // 一通呼叫的索引视图，指向 mmap 的 index.dat
+    struct CallView {
+        uint64_t callId;
+        uint64_t startNs;
+        const ArchiveIndexEntry *entries;
+        uint32_t count;
+
+        // 第一条相对时间 >= relMs 的记录下标
+        uint32_t seek(uint32_t relMs) const {
+            const ArchiveIndexEntry *it = std::lower_bound(entries, entries + count, relMs,
+                [](const ArchiveIndexEntry &e, uint32_t t) { return e.relMs < t; });
+            return static_cast<uint32_t>(it - entries);
+        }
+    };
+
+    explicit ArchiveReader(const std::string &dir) : dir(dir), index(nullptr), indexSize(0) {}
+
+    ~ArchiveReader() {
+        for (auto &m : maps) {
+            if (m.base) {
+                munmap(const_cast<uint8_t *>(m.base), m.size);
+            }
+        }
+        if (index) {
+            munmap(const_cast<uint8_t *>(index), indexSize);
+        }
+    }
+
+    ArchiveReader(const ArchiveReader &) = delete;
+    ArchiveReader &operator=(const ArchiveReader &) = delete;
+
+    bool open() {
+        if (!mapFile(dir + "/index.dat", &index, &indexSize)) {
+            return false;
+        }
+        size_t off = 0;
+        while (off + sizeof(ArchiveIndexHeader) <= indexSize) {
+            ArchiveIndexHeader h;
+            memcpy(&h, index + off, sizeof(h));
+            size_t bytes = sizeof(h) + static_cast<size_t>(h.count) * sizeof(ArchiveIndexEntry);
+            if (off + bytes > indexSize) {
+                break; // 写了一半的索引
+            }
+            CallView v;
+            v.callId = h.callId;
+            v.startNs = h.startNs;
+            v.entries = reinterpret_cast<const ArchiveIndexEntry *>(index + off + sizeof(h));
+            v.count = h.count;
+            calls[h.callId] = v;
+            off += bytes;
+        }
+
+        maps.push_back(Mapping()); // 段号从 1 开始
+        for (uint32_t id = 1;; ++id) {
+            Mapping m;
+            if (!mapFile(archiveSegmentPath(dir, id), &m.base, &m.size)) {
+                break;
+            }
+            maps.push_back(m);
+        }
+        return true;
+    }
+
+    bool findCall(uint64_t callId, CallView &view) const {
+        auto it = calls.find(callId);
+        if (it == calls.end()) {
+            return false;
+        }
+        view = it->second;
+        return true;
+    }
+
+    std::vector<uint64_t> callIds() const {
+        std::vector<uint64_t> ids;
+        for (auto &kv : calls) {
+            ids.push_back(kv.first);
+        }
+        return ids;
+    }
+
+    bool record(const ArchiveIndexEntry &e, Record &r) const {
+        if (e.segment >= maps.size() || !maps[e.segment].base ||
+            e.offset + sizeof(ArchiveRecordHeader) > maps[e.segment].size) {
+            return false;
+        }
+        const uint8_t *p = maps[e.segment].base + e.offset;
+        ArchiveRecordHeader h;
+        memcpy(&h, p, sizeof(h));
+        if (e.offset + sizeof(h) + h.length > maps[e.segment].size) {
+            return false;
+        }
+        r.callId = h.callId;
+        r.timeNs = h.timeNs;
+        r.kind = h.kind;
+        r.data = p + sizeof(h);
+        r.length = h.length;
+        return true;
+    }
+
+    /**
+     * @brief 取出呼叫在 [fromMs, toMs) (相对呼叫开始) 内的记录，不拷贝负载.
+     * @return 回调次数.
+     */
+    template <typename F>
+    size_t extract(uint64_t callId, uint32_t fromMs, uint32_t toMs, F f) const {
+        CallView v;
+        if (!findCall(callId, v)) {
+            return 0;
+        }
+        size_t n = 0;
+        Record r;
+        for (uint32_t i = v.seek(fromMs); i < v.count && v.entries[i].relMs < toMs; ++i) {
+            if (record(v.entries[i], r)) {
+                f(r);
+                ++n;
+            }
+        }
+        return n;
+    }
+
+private:
+    struct Mapping {
+        const uint8_t *base = nullptr;
+        size_t size = 0;
+    };
+
+    static bool mapFile(const std::string &path, const uint8_t **base, size_t *size) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) < 0) {
+            close(fd);
+            return false;
+        }
+        // 空文件不能 mmap，当作有效的空映射
+        if (st.st_size == 0) {
+            close(fd);
+            *base = nullptr;
+            *size = 0;
+            return true;
+        }
+        void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) {
+            return false;
+        }
+        *base = static_cast<const uint8_t *>(p);
+        *size = st.st_size;
+        return true;
+    }
+
+    std::string dir;
+    const uint8_t *index;
+    size_t indexSize;
+    std::unordered_map<uint64_t, CallView> calls;
+    std::vector<Mapping> maps;
+};
+
+#endif // RTP_CALL_ARCHIVE_H
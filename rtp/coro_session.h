@@ -0,0 +1,417 @@
+#ifndef RTP_CORO_SESSION_H
+#define RTP_CORO_SESSION_H
+
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <queue>
+#include <vector>
+#include <poll.h>
+#include <time.h>
+
+/*
+C++20 协程会话 API。
+
+一通呼叫不再占用 senderThread/receiverThread 两个线程，而是一个协程帧：
+    Task dialog(FrameTransport *t) {
+        CoroSession s(t);
+        co_await s.play(greeting);
+        auto frame = co_await s.next_frame();
+        co_await sleep_until(deadline);
+    }
+所有协程都在 EventLoop 所在的单线程上运行：runOnce() 处理定时器、
+轮询每个会话的收发，然后恢复就绪的协程。协程之间不需要加锁。
+run() 在所有会话的 socket 上 ppoll()，超时取最近的定时器/收帧超时/发帧时刻，
+只有可读的会话才调用 transport 的 poll()，空闲时不产生每会话的系统调用。
+*/
+
+namespace coro {
+
+using Clock = std::chrono::steady_clock;
+
+// 媒体收发的抽象，RTP 实现见 dialog.cc，基准测试用内存回环
+class FrameTransport {
+public:
+    static const int MAX_FDS = 2;
+
+    virtual ~FrameTransport() {}
+    virtual void poll() {}
+    // 可读时需要 poll() 的描述符 (例如 RTP/RTCP socket)，返回个数；
+    // 返回 0 的 transport 在 run() 的每一轮都 poll()
+    virtual int fds(int out[MAX_FDS]) const { return 0; }
+    // 取出一个收到的帧，没有则返回 false
+    virtual bool receive(std::vector<uint8_t> &frame) = 0;
+    virtual void send(const uint8_t *data, size_t len) = 0;
+};
+
+// 即发即忘的协程，由 EventLoop::spawn 启动，结束时自动释放协程帧
+struct Task {
+    struct promise_type {
+        // 统计协程帧占用的内存，用于和线程模型对比
+        static inline size_t liveBytes = 0;
+        static inline size_t liveFrames = 0;
+
+        static void *operator new(size_t n) {
+            liveBytes += n;
+            ++liveFrames;
+            return ::operator new(n);
+        }
+        static void operator delete(void *p, size_t n) {
+            liveBytes -= n;
+            --liveFrames;
+            ::operator delete(p);
+        }
+
+        Task get_return_object() { return Task {std::coroutine_handle<promise_type>::from_promise(*this)}; }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+class CoroSession;
+
+class EventLoop {
+public:
+    EventLoop() : nowTime(Clock::now()), running(false) {}
+
+    // 正在 runOnce 中的事件循环，供 sleep_until() 使用
+    static EventLoop *&current() {
+        static thread_local EventLoop *loop = nullptr;
+        return loop;
+    }
+
+    void spawn(Task task) { ready.push_back(task.handle); }
+    Clock::time_point now() const { return nowTime; }
+
+    void schedule(Clock::time_point deadline, std::coroutine_handle<> h) {
+        timers.push(Timer {deadline, seq++, h});
+    }
+
+    void add(CoroSession *s) { sessions.push_back(s); }
+
+    void remove(CoroSession *s) {
+        for (size_t i = 0; i < sessions.size(); ++i) {
+            if (sessions[i] == s) {
+                sessions[i] = sessions.back();
+                sessions.pop_back();
+                return;
+            }
+        }
+    }
+
+    // 处理到 now 为止的所有事件，poll() 每个 transport
+    void runOnce(Clock::time_point now) { dispatch(now, true); }
+
+    /**
+     * @brief 运行直到 stop() 或没有会话和定时器.
+     * @param pollInterval 没有描述符的 transport 的轮询周期
+     */
+    inline void run(Clock::duration pollInterval = std::chrono::milliseconds(5));
+
+    void stop() { running = false; }
+
+    size_t sessionCount() const { return sessions.size(); }
+
+private:
+    struct Timer {
+        Clock::time_point deadline;
+        uint64_t seq; // 同一时刻的定时器按注册顺序触发
+        std::coroutine_handle<> handle;
+
+        bool operator>(const Timer &o) const {
+            return deadline != o.deadline ? deadline > o.deadline : seq > o.seq;
+        }
+    };
+
+    inline void dispatch(Clock::time_point now, bool pollAll);
+
+    Clock::time_point nowTime;
+    bool running;
+    uint64_t seq = 0;
+    std::vector<std::coroutine_handle<>> ready;
+    std::vector<std::coroutine_handle<>> resumeList;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers;
+    std::vector<CoroSession *> sessions;
+    std::vector<pollfd> pollFds;
+    std::vector<CoroSession *> pollOwners;
+};
+
+class CoroSession {
+public:
+    /**
+     * @param transport 媒体收发，生命周期由调用者管理
+     * @param frameBytes play() 每帧发送的字节数，默认 20ms L16 @ 8kHz
+     * @param maxQueued 没有协程等待时最多缓存的接收帧数，超出丢弃最旧的
+     */
+    explicit CoroSession(FrameTransport *transport, size_t frameBytes = 320,
+                         Clock::duration frameInterval = std::chrono::milliseconds(20),
+                         size_t maxQueued = 50) :
+        loop(*EventLoop::current()), transport(transport), frameBytes(frameBytes),
+        frameInterval(frameInterval), maxQueued(maxQueued), isClosed(false), readable(false),
+        frameOut(nullptr), playData(nullptr), playLen(0), playPos(0) {
+        loop.add(this);
+    }
+
+    ~CoroSession() {
+        loop.remove(this);
+    }
+
+    CoroSession(const CoroSession &) = delete;
+    CoroSession &operator=(const CoroSession &) = delete;
+
+    struct NextFrame {
+        CoroSession &s;
+        std::vector<uint8_t> frame;
+        Clock::time_point deadline; // time_point::max() 表示不限时
+
+        bool await_ready() {
+            if (!s.inbox.empty()) {
+                frame.swap(s.inbox.front());
+                s.inbox.pop_front();
+                return true;
+            }
+            return s.isClosed || s.loop.now() >= deadline;
+        }
+        void await_suspend(std::coroutine_handle<> h) {
+            s.frameWaiter = h;
+            s.frameOut = &frame;
+            s.frameDeadline = deadline;
+        }
+        // 会话关闭或超时后返回空帧
+        std::vector<uint8_t> await_resume() { return std::move(frame); }
+    };
+
+    struct Play {
+        CoroSession &s;
+        const uint8_t *data;
+        size_t len;
+
+        bool await_ready() { return len == 0 || s.isClosed; }
+        void await_suspend(std::coroutine_handle<> h) {
+            s.playData = data;
+            s.playLen = len;
+            s.playPos = 0;
+            s.nextSend = s.loop.now();
+            s.playWaiter = h;
+        }
+        void await_resume() {}
+    };
+
+    NextFrame next_frame() { return NextFrame {*this, {}, Clock::time_point::max()}; }
+
+    // 到 deadline 还没收到帧时返回空帧，run() 在 deadline 醒来
+    NextFrame next_frame(Clock::time_point deadline) { return NextFrame {*this, {}, deadline}; }
+
+    // 按帧间隔节拍发送 buffer，全部发完后恢复；buffer 在 co_await 期间必须有效
+    Play play(const std::vector<uint8_t> &buffer) { return Play {*this, buffer.data(), buffer.size()}; }
+    Play play(const uint8_t *data, size_t len) { return Play {*this, data, len}; }
+
+    // 丢弃收到但还没取走的帧，例如播放提示音之后
+    void flush() { inbox.clear(); }
+
+    // 唤醒所有等待者，之后 next_frame 返回空帧
+    void close() { isClosed = true; }
+    bool closed() const { return isClosed; }
+
+private:
+    friend class EventLoop;
+
+    // JRTPLIB 的 RTCP 也在 Poll() 里发送，socket 一直不可读时按这个周期补一次
+    static constexpr Clock::duration IDLE_POLL = std::chrono::milliseconds(100);
+
+    // 由 EventLoop 调用，需要恢复的协程追加到 out
+    void service(std::vector<std::coroutine_handle<>> &out, bool pollAll) {
+        int fd[FrameTransport::MAX_FDS];
+        if (pollAll || readable || transport->fds(fd) == 0 || loop.now() - lastPoll >= IDLE_POLL) {
+            transport->poll();
+            lastPoll = loop.now();
+            readable = false;
+        }
+        std::vector<uint8_t> frame;
+        while (!isClosed && transport->receive(frame)) {
+            if (frameWaiter) {
+                frameOut->swap(frame);
+                out.push_back(frameWaiter);
+                frameWaiter = nullptr;
+            } else {
+                if (inbox.size() >= maxQueued) {
+                    inbox.pop_front();
+                }
+                inbox.push_back(std::move(frame));
+            }
+            frame.clear();
+        }
+
+        Clock::time_point now = loop.now();
+        if (frameWaiter && now >= frameDeadline) {
+            out.push_back(frameWaiter);
+            frameWaiter = nullptr;
+        }
+        while (playWaiter && !isClosed && now >= nextSend) {
+            size_t n = playLen - playPos < frameBytes ? playLen - playPos : frameBytes;
+            transport->send(playData + playPos, n);
+            playPos += n;
+            nextSend += frameInterval;
+            if (playPos >= playLen) {
+                out.push_back(playWaiter);
+                playWaiter = nullptr;
+            }
+        }
+
+        if (isClosed) {
+            if (frameWaiter) {
+                out.push_back(frameWaiter);
+                frameWaiter = nullptr;
+            }
+            if (playWaiter) {
+                out.push_back(playWaiter);
+                playWaiter = nullptr;
+            }
+        }
+    }
+
+    // 下一次需要 service 的时刻，不含 socket 可读
+    Clock::time_point wakeTime(Clock::duration pollInterval) const {
+        int fd[FrameTransport::MAX_FDS];
+        Clock::time_point t = lastPoll + (transport->fds(fd) > 0 ? IDLE_POLL : pollInterval);
+        if (isClosed && (frameWaiter || playWaiter)) {
+            return loop.now();
+        }
+        if (frameWaiter && frameDeadline < t) {
+            t = frameDeadline;
+        }
+        if (playWaiter && nextSend < t) {
+            t = nextSend;
+        }
+        return t;
+    }
+
+    EventLoop &loop;
+    FrameTransport *transport;
+    size_t frameBytes;
+    Clock::duration frameInterval;
+    size_t maxQueued;
+    bool isClosed;
+    bool readable; // run() 发现描述符可读
+    Clock::time_point lastPoll;
+    std::deque<std::vector<uint8_t>> inbox;
+
+    std::coroutine_handle<> frameWaiter;
+    std::vector<uint8_t> *frameOut;
+    Clock::time_point frameDeadline;
+
+    std::coroutine_handle<> playWaiter;
+    const uint8_t *playData;
+    size_t playLen;
+    size_t playPos;
+    Clock::time_point nextSend;
+};
+
+inline void EventLoop::dispatch(Clock::time_point now, bool pollAll) {
+    EventLoop *prev = current();
+    current() = this;
+    nowTime = now;
+
+    // 新启动的协程可能再 spawn，逐个取出
+    while (!ready.empty()) {
+        std::coroutine_handle<> h = ready.back();
+        ready.pop_back();
+        h.resume();
+    }
+
+    while (!timers.empty() && timers.top().deadline <= now) {
+        std::coroutine_handle<> h = timers.top().handle;
+        timers.pop();
+        h.resume();
+    }
+
+    // 先收集再恢复：协程结束时会析构自己的 CoroSession 并修改 sessions
+    resumeList.clear();
+    for (CoroSession *s : sessions) {
+        s->service(resumeList, pollAll);
+    }
+    for (size_t i = 0; i < resumeList.size(); ++i) {
+        resumeList[i].resume();
+    }
+
+    current() = prev;
+}
+
+inline void EventLoop::run(Clock::duration pollInterval) {
+    running = true;
+    dispatch(Clock::now(), false);
+    while (running) {
+        if (sessions.empty() && timers.empty() && ready.empty()) {
+            break;
+        }
+
+        Clock::time_point wake = Clock::time_point::max();
+        if (!ready.empty()) {
+            wake = nowTime;
+        }
+        if (!timers.empty() && timers.top().deadline < wake) {
+            wake = timers.top().deadline;
+        }
+        pollFds.clear();
+        pollOwners.clear();
+        for (CoroSession *s : sessions) {
+            Clock::time_point t = s->wakeTime(pollInterval);
+            if (t < wake) {
+                wake = t;
+            }
+            int fd[FrameTransport::MAX_FDS];
+            int n = s->transport->fds(fd);
+            for (int i = 0; i < n; ++i) {
+                pollFds.push_back(pollfd {fd[i], POLLIN, 0});
+                pollOwners.push_back(s);
+            }
+        }
+
+        // 等到最近的截止时刻或任一 socket 可读
+        Clock::duration wait = wake - Clock::now();
+        if (wait < Clock::duration::zero()) {
+            wait = Clock::duration::zero();
+        }
+        timespec ts;
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(wait).count();
+        ts.tv_sec = static_cast<time_t>(ns / 1000000000);
+        ts.tv_nsec = static_cast<long>(ns % 1000000000);
+        if (ppoll(pollFds.data(), pollFds.size(), &ts, nullptr) > 0) {
+            for (size_t i = 0; i < pollFds.size(); ++i) {
+                if (pollFds[i].revents) {
+                    pollOwners[i]->readable = true;
+                }
+            }
+        }
+
+        dispatch(Clock::now(), false);
+    }
+}
+
+struct SleepUntil {
+    Clock::time_point deadline;
+
+    bool await_ready() { return EventLoop::current()->now() >= deadline; }
+    void await_suspend(std::coroutine_handle<> h) { EventLoop::current()->schedule(deadline, h); }
+    void await_resume() {}
+};
+
+// 只能在 EventLoop 上运行的协程中使用
+inline SleepUntil sleep_until(Clock::time_point deadline) {
+    return SleepUntil {deadline};
+}
+
+inline SleepUntil sleep_for(Clock::duration d) {
+    return SleepUntil {EventLoop::current()->now() + d};
+}
+
+} // namespace coro
+
+#endif // RTP_CORO_SESSION_H
@@ -0,0 +1,171 @@
+#include <iostream>
+#include <chrono>
+#include <cstring>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "rtp_packet.h"
+#include "rtp_probes.h"
+#include "ssrc_map.h"
+
+/*
+一个端口上多个 SSRC 的解复用：直接从 UDP 套接字收包，SsrcMap 就是解复用本身，
+不经过 JRTPLIB 的源表。
+RTP 在 PORT_BASE，RTCP 在 PORT_BASE + 1，RTCP 只解析 BYE 用来删除源。
+同一 SSRC 来自不同传输地址时 SsrcMap 报告冲突，包丢弃。
+*/
+
+#define SAMPLE_RATE 8000
+#define PORT_BASE 9000
+#define MAX_SOURCES 4096
+#define SOURCE_TIMEOUT_MS 5000
+#define STATS_INTERVAL_MS 5000
+#define POLL_TIMEOUT_MS 10
+#define RTCP_BYE 203
+
+// 每个源的状态，RFC 3550 A.1 / A.8 的接收统计，保持在一条缓存行内
+struct SourceState {
+    uint32_t baseSeq;
+    uint32_t maxSeq;   // 扩展序列号
+    uint32_t received;
+    int32_t transit;
+    uint32_t jitter;   // Q4 定点，单位为时间戳
+
+    SourceState() : baseSeq(0), maxSeq(0), received(0), transit(0), jitter(0) {}
+
+    void update(uint16_t seq, uint32_t timestamp, uint32_t arrival) {
+        int32_t t = static_cast<int32_t>(arrival - timestamp);
+        if (received == 0) {
+            baseSeq = seq;
+            maxSeq = seq;
+        } else {
+            int32_t d = t - transit;
+            if (d < 0) {
+                d = -d;
+            }
+            jitter += d - ((jitter + 8) >> 4);
+            // 比最大序列号新 (含回绕) 时前进，乱序的旧包不动
+            uint16_t delta = static_cast<uint16_t>(seq - static_cast<uint16_t>(maxSeq));
+            if (delta != 0 && delta < 0x8000) {
+                maxSeq += delta;
+            }
+        }
+        transit = t;
+        ++received;
+    }
+
+    uint32_t expected() const { return maxSeq - baseSeq + 1; }
+};
+
+static int64_t nowMs() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static int openSocket(uint16_t port) {
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// 复合 RTCP 包里每个 BYE 列出的 SSRC 都删掉
+static void handleRtcp(const uint8_t *p, size_t len, SsrcMap<SourceState> &sources) {
+    size_t off = 0;
+    while (off + 4 <= len && (p[off] >> 6) == 2) {
+        size_t bytes = (rtpGet16(p + off + 2) + 1) * 4;
+        if (off + bytes > len) {
+            break;
+        }
+        if (p[off + 1] == RTCP_BYE) {
+            int count = p[off] & 0x1f;
+            for (int i = 0; i < count && 8 + i * 4 <= static_cast<int>(bytes); ++i) {
+                uint32_t ssrc = rtpGet32(p + off + 4 + i * 4);
+                if (sources.erase(ssrc)) {
+                    std::cout << "Source " << ssrc << " left (BYE)" << std::endl;
+                }
+            }
+        }
+        off += bytes;
+    }
+}
+
+int main() {
+    int rtpFd = openSocket(PORT_BASE);
+    int rtcpFd = openSocket(PORT_BASE + 1);
+    if (rtpFd < 0 || rtcpFd < 0) {
+        perror("bind");
+        return 1;
+    }
+
+    SsrcMap<SourceState> sources(MAX_SOURCES);
+    int64_t lastStats = nowMs();
+    uint8_t buf[RTP_MAX_PACKET];
+
+    std::cout << "Demultiplexing SSRCs on port " << PORT_BASE << "..." << std::endl;
+
+    while (true) {
+        pollfd fds[2] = {{rtpFd, POLLIN, 0}, {rtcpFd, POLLIN, 0}};
+        poll(fds, 2, POLL_TIMEOUT_MS);
+        int64_t now = nowMs();
+        uint32_t arrival = static_cast<uint32_t>(now * (SAMPLE_RATE / 1000));
+
+        sockaddr_in from;
+        socklen_t fromLen = sizeof(from);
+        ssize_t n;
+        while ((n = recvfrom(rtpFd, buf, sizeof(buf), 0, reinterpret_cast<sockaddr *>(&from), &fromLen)) > 0) {
+            fromLen = sizeof(from);
+            RtpHeader h;
+            if (rtpParseHeader(buf, n, h) == 0) {
+                continue;
+            }
+            RTP_PROBE_RECEIVED(&sources, h.ssrc, h.seq, h.timestamp);
+            SsrcMap<SourceState>::Result result;
+            SourceState *state = sources.lookup(h.ssrc, ntohl(from.sin_addr.s_addr), ntohs(from.sin_port), now,
+                                                &result);
+            if (state) {
+                if (result == SsrcMap<SourceState>::SSRC_INSERTED) {
+                    std::cout << "New source SSRC " << h.ssrc << std::endl;
+                }
+                state->update(h.seq, h.timestamp, arrival);
+            } else if (result == SsrcMap<SourceState>::SSRC_COLLISION) {
+                std::cerr << "SSRC collision " << h.ssrc << " from " << inet_ntoa(from.sin_addr) << ":"
+                          << ntohs(from.sin_port) << ", packet dropped" << std::endl;
+            } else if (result == SsrcMap<SourceState>::SSRC_FULL) {
+                std::cerr << "Source table full, SSRC " << h.ssrc << " dropped" << std::endl;
+            }
+        }
+        while ((n = recv(rtcpFd, buf, sizeof(buf), 0)) > 0) {
+            handleRtcp(buf, n, sources);
+        }
+
+        if (now - lastStats >= STATS_INTERVAL_MS) {
+            sources.evictIdle(now, SOURCE_TIMEOUT_MS, [](uint32_t ssrc, SourceState &) {
+                std::cout << "Source " << ssrc << " timed out" << std::endl;
+            });
+            sources.forEach([](uint32_t ssrc, SourceState &s) {
+                std::cout << "SSRC " << ssrc << ": received=" << s.received
+                          << " lost=" << static_cast<int32_t>(s.expected() - s.received)
+                          << " jitter=" << (s.jitter >> 4) << std::endl;
+            });
+            lastStats = now;
+        }
+    }
+
+    close(rtpFd);
+    close(rtcpFd);
+    return 0;
+}
@@ -0,0 +1,172 @@
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <vector>
+#include <arpa/inet.h>
+#include <jrtplib3/rtppacket.h>
+
+#include "coro_session.h"
+#include "rtp_probes.h"
+#include "session_pool.h"
+
+using namespace jrtplib;
+using namespace coro;
+
+/*
+协程版语音机器人对话：问候 -> 听 -> 回应 -> 挂断，一个协程一通呼叫，全部跑在一个线程上。
+第 i 通呼叫本地端口 PORT_BASE + 2 * i，对端端口 DEST_PORT_BASE + 2 * i，
+两段端口不能重叠，呼叫数最多 MAX_CALLS。
+用法: dialog [呼叫数]
+*/
+
+#define SAMPLE_RATE 8000
+#define FRAMES_PER_BUFFER 160
+#define PORT_BASE 20000
+#define DEST_IP "127.0.0.1"
+#define DEST_PORT_BASE 30000
+#define SPEECH_THRESHOLD 1e6     // 平均能量，超过认为在说话
+#define END_OF_SPEECH_FRAMES 25  // 说话后静音 500ms 认为说完
+#define LISTEN_TIMEOUT_SEC 10
+#define MAX_CALLS ((DEST_PORT_BASE - PORT_BASE) / 2)
+
+// JRTPLIB 会话上的帧收发，EventLoop 在池绑定的 RTP/RTCP socket 上等待
+class RtpTransport : public FrameTransport {
+public:
+    explicit RtpTransport(PooledSession *call) :
+        sess(&call->session), rtpSocket(call->rtpSocket), rtcpSocket(call->rtcpSocket) {}
+
+    int fds(int out[MAX_FDS]) const override {
+        out[0] = rtpSocket;
+        out[1] = rtcpSocket;
+        return 2;
+    }
+
+    void poll() override {
+        sess->Poll();
+        sess->BeginDataAccess();
+        if (sess->GotoFirstSourceWithData()) {
+            do {
+                RTPPacket *packet;
+                while ((packet = sess->GetNextPacket()) != nullptr) {
+                    RTP_PROBE_RECEIVED(sess, packet->GetSSRC(), packet->GetSequenceNumber(), packet->GetTimestamp());
+                    const uint8_t *p = packet->GetPayloadData();
+                    received.push_back(std::vector<uint8_t>(p, p + packet->GetPayloadLength()));
+                    RTP_PROBE_QUEUED(sess, packet->GetSSRC(), packet->GetSequenceNumber(), packet->GetTimestamp());
+                    sess->DeletePacket(packet);
+                }
+            } while (sess->GotoNextSourceWithData());
+        }
+        sess->EndDataAccess();
+    }
+
+    bool receive(std::vector<uint8_t> &frame) override {
+        if (received.empty()) {
+            return false;
+        }
+        frame.swap(received.front());
+        received.pop_front();
+        return true;
+    }
+
+    // 池里是 ProbedSession，packet_sent 探针在包真正发出时触发
+    void send(const uint8_t *data, size_t len) override {
+        sess->SendPacket(data, len, 0, false, static_cast<uint32_t>(len / sizeof(int16_t)));
+    }
+
+private:
+    RTPSession *sess;
+    int rtpSocket;
+    int rtcpSocket;
+    std::deque<std::vector<uint8_t>> received;
+};
+
+static std::vector<uint8_t> makeTone(float freq, float seconds) {
+    std::vector<int16_t> pcm(static_cast<size_t>(SAMPLE_RATE * seconds));
+    for (size_t i = 0; i < pcm.size(); ++i) {
+        pcm[i] = static_cast<int16_t>(0.3 * 32767 * std::sin(2 * M_PI * freq * i / SAMPLE_RATE));
+    }
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(pcm.data());
+    return std::vector<uint8_t>(p, p + pcm.size() * sizeof(int16_t));
+}
+
+static double frameEnergy(const std::vector<uint8_t> &frame) {
+    const int16_t *s = reinterpret_cast<const int16_t *>(frame.data());
+    size_t n = frame.size() / sizeof(int16_t);
+    double e = 0;
+    for (size_t i = 0; i < n; ++i) {
+        e += static_cast<double>(s[i]) * s[i];
+    }
+    return n ? e / n : 0;
+}
+
+static Task dialog(SessionPool *pool, PooledSession *call, int id,
+                   const std::vector<uint8_t> *greeting, const std::vector<uint8_t> *response) {
+    RtpTransport transport(call);
+    CoroSession s(&transport);
+
+    // 1. 问候
+    co_await s.play(*greeting);
+    s.flush();
+
+    // 2. 听：等到说话并且静音 END_OF_SPEECH_FRAMES 帧，或超时
+    Clock::time_point deadline = EventLoop::current()->now() + std::chrono::seconds(LISTEN_TIMEOUT_SEC);
+    bool spoke = false;
+    int silent = 0;
+    while (true) {
+        // 对端一直不发包时在 deadline 返回空帧
+        std::vector<uint8_t> frame = co_await s.next_frame(deadline);
+        if (frame.empty()) {
+            break;
+        }
+        if (frameEnergy(frame) > SPEECH_THRESHOLD) {
+            spoke = true;
+            silent = 0;
+        } else if (spoke && ++silent >= END_OF_SPEECH_FRAMES) {
+            break;
+        }
+    }
+    std::cout << "call " << id << (spoke ? ": caller spoke" : ": no speech") << std::endl;
+
+    // 3. 回应，稍作停顿后挂断
+    co_await s.play(*response);
+    co_await sleep_for(std::chrono::milliseconds(200));
+
+    s.close();
+    pool->release(call);
+}
+
+int main(int argc, char *argv[]) {
+    int calls = argc > 1 ? atoi(argv[1]) : 1;
+    if (calls < 1 || calls > MAX_CALLS) {
+        std::cerr << "call count must be 1.." << MAX_CALLS << std::endl;
+        return 1;
+    }
+
+    SessionPool pool(PORT_BASE, calls, 1.0 / SAMPLE_RATE);
+    if (pool.init() < 0) {
+        std::cerr << "Error creating RTP sessions!" << std::endl;
+        return 1;
+    }
+
+    std::vector<uint8_t> greeting = makeTone(440.0f, 1.0f);
+    std::vector<uint8_t> response = makeTone(660.0f, 0.5f);
+    uint32_t ip = ntohl(inet_addr(DEST_IP));
+
+    EventLoop loop;
+    for (int i = 0; i < calls; ++i) {
+        PooledSession *call = pool.acquire(ip, static_cast<uint16_t>(DEST_PORT_BASE + 2 * i));
+        if (!call) {
+            std::cerr << "Session pool exhausted" << std::endl;
+            break;
+        }
+        loop.spawn(dialog(&pool, call, i, &greeting, &response));
+    }
+
+    std::cout << calls << " dialogs running on one thread..." << std::endl;
+    loop.run();
+    pool.stop();
+
+    return 0;
+}
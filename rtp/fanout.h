@@ -0,0 +1,196 @@
+#ifndef RTP_FANOUT_H
+#define RTP_FANOUT_H
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "rtp_packet.h"
+
+/*
+一路媒体编码、打包一次，发给多个收听方 (广播通知、班长监听、录音镜像)。
+
+每个目的地是一个独立的 RTP 流：自己的 SSRC、连续的序列号和时间戳偏移，
+所以中途加入的收听方看到的序列号也从自己的起点开始。发送时共享同一份负载，
+每个目的地只重写 12 字节固定头里的 SSRC/序列号/时间戳，用两段 iovec (头 + 共享负载) 拼包，
+一次 sendmmsg 提交最多 FANOUT_BATCH 个目的地。
+
+组播：目的地可以是组播组 (一个组只占一个目的地)，发送套接字用 fanoutSetMulticast() 选出接口，
+接收端用 fanoutJoinGroup() 加入；接口选 127.0.0.1 并打开 loop 时可以在本机回环上测试。
+IP 地址均为主机字节序 (与 JRTPLIB 一致)。
+*/
+
+#define FANOUT_BATCH 256
+
+class RtpFanout {
+public:
+    // fd: 已创建的 UDP 套接字，由调用者管理
+    explicit RtpFanout(int fd) : fd(fd), sent(0), failed(0) {
+        msgs.resize(FANOUT_BATCH);
+        iov.resize(FANOUT_BATCH * 2);
+    }
+
+    /**
+     * @brief 增加一个目的地.
+     * @param seq、tsOffset 初始序列号和时间戳偏移，RFC 3550 要求随机；为 0 时由 SSRC 推出
+     * @return false 表示 SSRC 已存在
+     */
+    bool addDestination(uint32_t ip, uint16_t port, uint32_t ssrc, uint16_t seq = 0, uint32_t tsOffset = 0) {
+        if (find(ssrc) >= 0) {
+            return false;
+        }
+        uint64_t mix = ssrc * 0x9e3779b97f4a7c15ull;
+        Destination d;
+        memset(&d.addr, 0, sizeof(d.addr));
+        d.addr.sin_family = AF_INET;
+        d.addr.sin_addr.s_addr = htonl(ip);
+        d.addr.sin_port = htons(port);
+        d.ssrc = ssrc;
+        d.seq = seq ? seq : static_cast<uint16_t>(mix >> 48);
+        d.tsOffset = tsOffset ? tsOffset : static_cast<uint32_t>(mix >> 16);
+        memset(d.header, 0, sizeof(d.header));
+        dests.push_back(d);
+        return true;
+    }
+
+    bool removeDestination(uint32_t ssrc) {
+        int i = find(ssrc);
+        if (i < 0) {
+            return false;
+        }
+        dests[i] = dests.back();
+        dests.pop_back();
+        return true;
+    }
+
+    size_t destinations() const { return dests.size(); }
+
+    /**
+     * @brief 把一个完整 RTP 包发给所有目的地.
+     *
+     * 包头里的 V/P/X/CC、M/PT 和 CSRC/扩展头原样保留，只替换序列号、时间戳和 SSRC。
+     * 发送失败 (例如套接字缓冲满) 的目的地本帧丢弃，序列号照常前进，对端看到的是丢包。
+     * @return 成功发出的包数，包格式错误返回 -1.
+     */
+    int send(const uint8_t *packet, size_t len) {
+        RtpHeader h;
+        if (rtpParseHeader(packet, len, h) == 0) {
+            return -1;
+        }
+        int total = 0;
+        for (size_t base = 0; base < dests.size(); base += FANOUT_BATCH) {
+            size_t n = dests.size() - base < FANOUT_BATCH ? dests.size() - base : FANOUT_BATCH;
+            for (size_t i = 0; i < n; ++i) {
+                Destination &d = dests[base + i];
+                d.header[0] = packet[0];
+                d.header[1] = packet[1];
+                rtpPut16(d.header + 2, d.seq++);
+                rtpPut32(d.header + 4, h.timestamp + d.tsOffset);
+                rtpPut32(d.header + 8, d.ssrc);
+
+                iov[2 * i].iov_base = d.header;
+                iov[2 * i].iov_len = RTP_HEADER_SIZE;
+                iov[2 * i + 1].iov_base = const_cast<uint8_t *>(packet + RTP_HEADER_SIZE);
+                iov[2 * i + 1].iov_len = len - RTP_HEADER_SIZE;
+                msghdr &m = msgs[i].msg_hdr;
+                memset(&m, 0, sizeof(m));
+                m.msg_name = &d.addr;
+                m.msg_namelen = sizeof(d.addr);
+                m.msg_iov = &iov[2 * i];
+                m.msg_iovlen = 2;
+            }
+            total += submit(n);
+        }
+        sent += total;
+        return total;
+    }
+
+    uint64_t packetsSent() const { return sent; }
+    uint64_t packetsFailed() const { return failed; }
+
+private:
+    struct Destination {
+        sockaddr_in addr;
+        uint32_t ssrc;
+        uint32_t tsOffset;
+        uint16_t seq;
+        uint8_t header[RTP_HEADER_SIZE];
+    };
+
+    int find(uint32_t ssrc) const {
+        for (size_t i = 0; i < dests.size(); ++i) {
+            if (dests[i].ssrc == ssrc) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    // 提交 msgs[0, n)，返回成功数；出错的那个包跳过，继续提交后面的
+    int submit(size_t n) {
+        size_t done = 0;
+        int ok = 0;
+        while (done < n) {
+#ifdef __linux__
+            int r = sendmmsg(fd, &msgs[done], static_cast<unsigned>(n - done), 0);
+#else
+            int r = sendmsg(fd, &msgs[done].msg_hdr, 0) < 0 ? -1 : 1;
+#endif
+            if (r < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                ++failed;
+                ++done;
+                continue;
+            }
+            ok += r;
+            done += r;
+        }
+        return ok;
+    }
+
+    int fd;
+    std::vector<Destination> dests;
+#ifdef __linux__
+    std::vector<mmsghdr> msgs;
+#else
+    struct Msg {
+        msghdr msg_hdr;
+    };
+    std::vector<Msg> msgs;
+#endif
+    std::vector<iovec> iov;
+    uint64_t sent;
+    uint64_t failed;
+};
+
+// 发送套接字的组播设置：从 ifaceIp 接口发出，loop 为 true 时本机也收得到
+inline int fanoutSetMulticast(int fd, uint32_t ifaceIp, int ttl, bool loop) {
+    in_addr iface;
+    iface.s_addr = htonl(ifaceIp);
+    unsigned char t = static_cast<unsigned char>(ttl);
+    unsigned char l = loop ? 1 : 0;
+    if (setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &iface, sizeof(iface)) < 0 ||
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &t, sizeof(t)) < 0 ||
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &l, sizeof(l)) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+// 接收套接字在 ifaceIp 接口上加入组播组
+inline int fanoutJoinGroup(int fd, uint32_t group, uint32_t ifaceIp) {
+    ip_mreq mreq;
+    mreq.imr_multiaddr.s_addr = htonl(group);
+    mreq.imr_interface.s_addr = htonl(ifaceIp);
+    return setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq));
+}
+
+#endif // RTP_FANOUT_H
@@ -0,0 +1,773 @@
+#ifndef RTP_FEC_H
+#define RTP_FEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "rtp_packet.h"
+
+/*
+丢包恢复，不依赖重传：
+- RFC 2198 冗余音频：每个包捎带前 N 帧的副本；
+- RFC 5109 XOR 奇偶校验：每 K 个媒体包发一个 FEC 包，可恢复组内任意一个丢包。
+
+FEC 包用单独的 SSRC 和序列号空间发送，避免和媒体流混在 JRTPLIB 的同一个源里。
+接收端 FecPlayout 在抖动缓冲/播放之前完成恢复。
+*/
+
+#define RED_MAX_DISTANCE 3   // 最多携带的冗余帧数
+#define FEC_MAX_GROUP 16     // 短掩码 (L=0) 最多保护 16 个包
+#define FEC_HEADER_SIZE 10
+#define FEC_LEVEL_HEADER_SIZE 4
+#define FEC_MEDIA_WINDOW 64  // 接收端保存的媒体包数，必须是 2 的幂
+#define FEC_PLAYOUT_FRAMES 64
+#define FEC_DELAY_DECAY_FRAMES 500 // 连续这么多帧没有丢失/迟到，播放延迟减 1 帧 (10ms 帧约 5 秒)
+#define FEC_SSRC_MASK 0x5eed0001
+
+// ----------------------- SIMD XOR -----------------------
+
+// GCC/Clang 向量扩展，按目标指令集编译为 AVX2/SSE2/NEON，否则退化为标量
+typedef uint8_t FecVec __attribute__((vector_size(32)));
+
+/**
+ * @brief dst = src[0] ^ src[1] ^ ... ^ src[n-1]，每个源不足 len 的部分按 0 补齐.
+ *
+ * 按 32 字节分块，一块内把所有包累加在寄存器里再写回一次。
+ */
+inline void fecXorMany(uint8_t *dst, size_t len, const uint8_t *const *src, const size_t *srcLen, int n) {
+    size_t off = 0;
+    for (; off + sizeof(FecVec) <= len; off += sizeof(FecVec)) {
+        FecVec acc = {};
+        for (int j = 0; j < n; ++j) {
+            FecVec v;
+            if (off + sizeof(FecVec) <= srcLen[j]) {
+                memcpy(&v, src[j] + off, sizeof(v));
+            } else {
+                v = FecVec {};
+                if (off < srcLen[j]) {
+                    memcpy(&v, src[j] + off, srcLen[j] - off);
+                }
+            }
+            acc ^= v;
+        }
+        memcpy(dst + off, &acc, sizeof(acc));
+    }
+    for (; off < len; ++off) {
+        uint8_t acc = 0;
+        for (int j = 0; j < n; ++j) {
+            if (off < srcLen[j]) {
+                acc ^= src[j][off];
+            }
+        }
+        dst[off] = acc;
+    }
+}
+
+// ----------------------- RFC 2198 -----------------------
+
+struct RedBlock {
+    uint8_t payloadType;
+    uint32_t tsOffset; // 主编码为 0
+    const uint8_t *data;
+    size_t len;
+};
+
+/**
+ * @brief 组装 RED 负载，blocks 最后一个为主编码.
+ * @return 负载长度，空间不足或块不合法时返回 0.
+ */
+inline size_t redEncode(uint8_t *out, size_t cap, const RedBlock *blocks, int n) {
+    size_t need = (n - 1) * 4 + 1;
+    for (int i = 0; i < n; ++i) {
+        need += blocks[i].len;
+    }
+    if (n < 1 || need > cap) {
+        return 0;
+    }
+    uint8_t *p = out;
+    for (int i = 0; i < n - 1; ++i) {
+        if (blocks[i].tsOffset >= (1u << 14) || blocks[i].len >= (1u << 10)) {
+            return 0;
+        }
+        p[0] = static_cast<uint8_t>(0x80 | blocks[i].payloadType);
+        uint32_t v = (blocks[i].tsOffset << 10) | static_cast<uint32_t>(blocks[i].len);
+        p[1] = static_cast<uint8_t>(v >> 16);
+        p[2] = static_cast<uint8_t>(v >> 8);
+        p[3] = static_cast<uint8_t>(v);
+        p += 4;
+    }
+    *p++ = static_cast<uint8_t>(blocks[n - 1].payloadType & 0x7f);
+    for (int i = 0; i < n; ++i) {
+        memcpy(p, blocks[i].data, blocks[i].len);
+        p += blocks[i].len;
+    }
+    return need;
+}
+
+/**
+ * @brief 解析 RED 负载，块指针指向 payload 内部.
+ * @return 块数，格式错误返回 -1.
+ */
+inline int redDecode(const uint8_t *payload, size_t len, RedBlock *blocks, int max) {
+    size_t off = 0;
+    int n = 0;
+    size_t dataLen = 0;
+    while (true) {
+        if (off >= len || n >= max) {
+            return -1;
+        }
+        RedBlock &b = blocks[n++];
+        b.payloadType = payload[off] & 0x7f;
+        if (!(payload[off] & 0x80)) {
+            b.tsOffset = 0;
+            b.len = 0; // 主编码长度最后计算
+            off += 1;
+            break;
+        }
+        if (off + 4 > len) {
+            return -1;
+        }
+        uint32_t v = (payload[off + 1] << 16) | (payload[off + 2] << 8) | payload[off + 3];
+        b.tsOffset = v >> 10;
+        b.len = v & 0x3ff;
+        dataLen += b.len;
+        off += 4;
+    }
+    if (off + dataLen > len) {
+        return -1;
+    }
+    blocks[n - 1].len = len - off - dataLen;
+    for (int i = 0; i < n; ++i) {
+        blocks[i].data = payload + off;
+        off += blocks[i].len;
+    }
+    return n;
+}
+
+// len 字节的帧在 cap 字节的 RED 负载里最多能带几个等长的冗余帧
+inline int redMaxDistance(size_t len, size_t cap) {
+    if (len >= (1u << 10) || len + 1 > cap) {
+        return 0;
+    }
+    size_t d = (cap - len - 1) / (len + 4);
+    return d > RED_MAX_DISTANCE ? RED_MAX_DISTANCE : static_cast<int>(d);
+}
+
+class RedEncoder {
+public:
+    RedEncoder(uint8_t mediaPt) : mediaPt(mediaPt), distance(0), used(0), head(0) {
+        for (int i = 0; i < RED_MAX_DISTANCE; ++i) {
+            history[i].valid = false;
+        }
+    }
+
+    void setDistance(int d) { distance = d < 0 ? 0 : (d > RED_MAX_DISTANCE ? RED_MAX_DISTANCE : d); }
+    int getDistance() const { return distance; }
+
+    // 最近一次 encode() 实际带上的冗余帧数
+    int lastDistance() const { return used; }
+
+    /**
+     * @brief 编码一帧，返回 RED 负载长度.
+     *
+     * 冗余帧放不进 cap 时从最老的开始丢 (ptime 较长时一个包只装得下较少的冗余)，
+     * 只有主编码都放不下时才返回 0.
+     */
+    size_t encode(const uint8_t *frame, size_t len, uint32_t ts, uint8_t *out, size_t cap) {
+        RedBlock blocks[RED_MAX_DISTANCE + 1];
+        int n = 0;
+        for (int d = distance; d >= 1; --d) {
+            const Entry &e = history[(head + RED_MAX_DISTANCE - d) % RED_MAX_DISTANCE];
+            uint32_t offset = ts - e.ts;
+            if (e.valid && offset < (1u << 14) && e.data.size() < (1u << 10)) {
+                blocks[n].payloadType = mediaPt;
+                blocks[n].tsOffset = offset;
+                blocks[n].data = e.data.data();
+                blocks[n].len = e.data.size();
+                ++n;
+            }
+        }
+        blocks[n].payloadType = mediaPt;
+        blocks[n].tsOffset = 0;
+        blocks[n].data = frame;
+        blocks[n].len = len;
+        ++n;
+        size_t need = (n - 1) * 4 + 1;
+        for (int i = 0; i < n; ++i) {
+            need += blocks[i].len;
+        }
+        int first = 0;
+        while (first < n - 1 && need > cap) {
+            need -= blocks[first].len + 4;
+            ++first;
+        }
+        size_t total = redEncode(out, cap, blocks + first, n - first);
+        used = total > 0 ? n - 1 - first : 0;
+
+        Entry &slot = history[head];
+        slot.data.assign(frame, frame + len);
+        slot.ts = ts;
+        slot.valid = true;
+        head = (head + 1) % RED_MAX_DISTANCE;
+        return total;
+    }
+
+private:
+    struct Entry {
+        bool valid;
+        uint32_t ts;
+        std::vector<uint8_t> data;
+    };
+
+    uint8_t mediaPt;
+    int distance;
+    int used;
+    int head;
+    Entry history[RED_MAX_DISTANCE];
+};
+
+// ----------------------- RFC 5109 -----------------------
+
+// XOR FEC 流的 SSRC 由媒体 SSRC 推出，接收端据此只接受保护当前媒体流的奇偶包
+inline uint32_t fecSsrcFor(uint32_t mediaSsrc) { return mediaSsrc ^ FEC_SSRC_MASK; }
+
+class XorFecEncoder {
+public:
+    XorFecEncoder(uint8_t fecPt, uint32_t ssrc) :
+        fecPt(fecPt), ssrc(ssrc), seq(0), snBase(0), lastTs(0), groupSize(0), pendingSize(0), count(0) {}
+
+    // 0 关闭 FEC，新的组大小从下一组开始生效
+    void setGroupSize(int k) {
+        pendingSize = k < 0 ? 0 : (k > FEC_MAX_GROUP ? FEC_MAX_GROUP : k);
+        if (count == 0) {
+            groupSize = pendingSize;
+        }
+    }
+    int getGroupSize() const { return pendingSize; }
+
+    /**
+     * @brief 加入一个已序列化的媒体包.
+     * @return 组满时写入 out 的 FEC 包长度，否则 0.
+     */
+    size_t addMedia(const uint8_t *pkt, size_t len, uint8_t *out, size_t cap) {
+        if (groupSize == 0 || len < RTP_HEADER_SIZE) {
+            groupSize = pendingSize;
+            return 0;
+        }
+        if (count == 0) {
+            snBase = rtpGet16(pkt + 2);
+        }
+        packets[count].assign(pkt, pkt + len);
+        lastTs = rtpGet32(pkt + 4);
+        if (++count < groupSize) {
+            return 0;
+        }
+        size_t n = build(out, cap);
+        count = 0;
+        groupSize = pendingSize;
+        return n;
+    }
+
+private:
+    size_t build(uint8_t *out, size_t cap) {
+        const uint8_t *heads[FEC_MAX_GROUP];
+        const uint8_t *bodies[FEC_MAX_GROUP];
+        size_t bodyLens[FEC_MAX_GROUP];
+        size_t headLens[FEC_MAX_GROUP];
+        size_t protLen = 0;
+        uint16_t mask = 0;
+        uint16_t lenRecovery = 0;
+        for (int i = 0; i < count; ++i) {
+            heads[i] = packets[i].data();
+            headLens[i] = RTP_HEADER_SIZE;
+            bodies[i] = packets[i].data() + RTP_HEADER_SIZE;
+            bodyLens[i] = packets[i].size() - RTP_HEADER_SIZE;
+            if (bodyLens[i] > protLen) {
+                protLen = bodyLens[i];
+            }
+            lenRecovery ^= static_cast<uint16_t>(bodyLens[i]);
+            mask |= static_cast<uint16_t>(0x8000 >> static_cast<uint16_t>(rtpGet16(heads[i] + 2) - snBase));
+        }
+        size_t total = RTP_HEADER_SIZE + FEC_HEADER_SIZE + FEC_LEVEL_HEADER_SIZE + protLen;
+        if (total > cap) {
+            return 0;
+        }
+
+        RtpHeader h;
+        h.payloadType = fecPt;
+        h.seq = seq++;
+        h.timestamp = lastTs;
+        h.ssrc = ssrc;
+        rtpWriteHeader(out, h);
+
+        uint8_t bits[RTP_HEADER_SIZE];
+        fecXorMany(bits, RTP_HEADER_SIZE, heads, headLens, count);
+        uint8_t *fec = out + RTP_HEADER_SIZE;
+        fec[0] = bits[0] & 0x3f; // E=0, L=0
+        fec[1] = bits[1];
+        rtpPut16(fec + 2, snBase);
+        memcpy(fec + 4, bits + 4, 4);
+        rtpPut16(fec + 8, lenRecovery);
+        rtpPut16(fec + 10, static_cast<uint16_t>(protLen));
+        rtpPut16(fec + 12, mask);
+        fecXorMany(fec + 14, protLen, bodies, bodyLens, count);
+        return total;
+    }
+
+    uint8_t fecPt;
+    uint32_t ssrc;
+    uint16_t seq;
+    uint16_t snBase;
+    uint32_t lastTs;
+    int groupSize;
+    int pendingSize;
+    int count;
+    std::vector<uint8_t> packets[FEC_MAX_GROUP];
+};
+
+class XorFecDecoder {
+public:
+    XorFecDecoder() { reset(); }
+
+    // 丢弃缓存的媒体包和 FEC 包 (媒体流换了 SSRC 时调用)
+    void reset() {
+        for (int i = 0; i < FEC_MEDIA_WINDOW; ++i) {
+            media[i].valid = false;
+        }
+        parity.clear();
+        newest = 0;
+        haveNewest = false;
+    }
+
+    void addMedia(const uint8_t *pkt, size_t len) {
+        if (len < RTP_HEADER_SIZE) {
+            return;
+        }
+        uint16_t seq = rtpGet16(pkt + 2);
+        Entry &e = media[seq & (FEC_MEDIA_WINDOW - 1)];
+        e.valid = true;
+        e.seq = seq;
+        e.data.assign(pkt, pkt + len);
+        if (!haveNewest || static_cast<int16_t>(seq - newest) > 0) {
+            newest = seq;
+            haveNewest = true;
+        }
+    }
+
+    // 缓存一个 FEC 包，返回它保护的序列号跨度 (非法包返回 0)
+    int addParity(const uint8_t *pkt, size_t len) {
+        RtpHeader h;
+        size_t off = rtpParseHeader(pkt, len, h);
+        if (off == 0 || len < off + FEC_HEADER_SIZE + FEC_LEVEL_HEADER_SIZE ||
+            (pkt[off] & 0x40) || // 只支持短掩码
+            len < off + FEC_HEADER_SIZE + FEC_LEVEL_HEADER_SIZE + rtpGet16(pkt + off + 10)) {
+            return 0;
+        }
+        if (parity.size() >= 8) {
+            parity.erase(parity.begin());
+        }
+        parity.push_back(std::vector<uint8_t>(pkt + off, pkt + len));
+
+        uint16_t mask = rtpGet16(pkt + off + 12);
+        int span = 0;
+        for (int b = 0; b < FEC_MAX_GROUP; ++b) {
+            if (mask & (0x8000 >> b)) {
+                span = b + 1;
+            }
+        }
+        return span;
+    }
+
+    /**
+     * @brief 尝试用缓存的 FEC 包恢复一个丢失的媒体包.
+     * @return 恢复出的完整 RTP 包长度，没有可恢复的包返回 0.
+     */
+    size_t recover(uint8_t *out, size_t cap) {
+        size_t i = 0;
+        while (i < parity.size()) {
+            const uint8_t *fec = parity[i].data();
+            uint16_t snBase = rtpGet16(fec + 2);
+            uint16_t mask = rtpGet16(fec + 12);
+            int missing = -1;
+            int missingCount = 0;
+            const uint8_t *heads[FEC_MAX_GROUP + 1];
+            const uint8_t *bodies[FEC_MAX_GROUP + 1];
+            size_t headLens[FEC_MAX_GROUP + 1];
+            size_t bodyLens[FEC_MAX_GROUP + 1];
+            int n = 0;
+            for (int b = 0; b < FEC_MAX_GROUP; ++b) {
+                if (!(mask & (0x8000 >> b))) {
+                    continue;
+                }
+                uint16_t seq = static_cast<uint16_t>(snBase + b);
+                const Entry &e = media[seq & (FEC_MEDIA_WINDOW - 1)];
+                if (!e.valid || e.seq != seq) {
+                    missing = b;
+                    ++missingCount;
+                    continue;
+                }
+                heads[n] = e.data.data();
+                headLens[n] = RTP_HEADER_SIZE;
+                bodies[n] = e.data.data() + RTP_HEADER_SIZE;
+                bodyLens[n] = e.data.size() - RTP_HEADER_SIZE;
+                ++n;
+            }
+            bool stale = haveNewest && static_cast<int16_t>(newest - snBase) >= FEC_MEDIA_WINDOW - FEC_MAX_GROUP;
+            if (missingCount != 1 || n == 0) {
+                if (missingCount == 0 || stale) {
+                    parity.erase(parity.begin() + i);
+                } else {
+                    ++i;
+                }
+                continue;
+            }
+
+            size_t protLen = rtpGet16(fec + 10);
+            uint8_t bits[RTP_HEADER_SIZE];
+            fecXorMany(bits, RTP_HEADER_SIZE, heads, headLens, n);
+            uint16_t length = rtpGet16(fec + 8);
+            for (int j = 0; j < n; ++j) {
+                length ^= static_cast<uint16_t>(bodyLens[j]);
+            }
+            if (length > protLen || RTP_HEADER_SIZE + static_cast<size_t>(length) > cap) {
+                parity.erase(parity.begin() + i);
+                continue;
+            }
+
+            out[0] = static_cast<uint8_t>(0x80 | ((bits[0] ^ fec[0]) & 0x3f));
+            out[1] = bits[1] ^ fec[1];
+            rtpPut16(out + 2, static_cast<uint16_t>(snBase + missing));
+            for (int k = 0; k < 4; ++k) {
+                out[4 + k] = bits[4 + k] ^ fec[4 + k];
+            }
+            memcpy(out + 8, heads[0] + 8, 4); // SSRC 取组内任一媒体包
+
+            bodies[n] = fec + FEC_HEADER_SIZE + FEC_LEVEL_HEADER_SIZE;
+            bodyLens[n] = protLen;
+            fecXorMany(out + RTP_HEADER_SIZE, length, bodies, bodyLens, n + 1);
+
+            parity.erase(parity.begin() + i);
+            addMedia(out, RTP_HEADER_SIZE + length);
+            return RTP_HEADER_SIZE + length;
+        }
+        return 0;
+    }
+
+private:
+    struct Entry {
+        bool valid;
+        uint16_t seq;
+        std::vector<uint8_t> data;
+    };
+
+    Entry media[FEC_MEDIA_WINDOW];
+    std::vector<std::vector<uint8_t>> parity;
+    uint16_t newest;
+    bool haveNewest;
+};
+
+// ----------------------- 自适应冗余 -----------------------
+
+struct FecLevel {
+    int redDistance;
+    int xorGroup;
+};
+
+// 根据 RTCP RR 的丢包率 (0..1) 选择冗余度
+inline FecLevel fecLevelForLoss(double fractionLost) {
+    FecLevel level;
+    if (fractionLost < 0.01) {
+        level.redDistance = 0;
+        level.xorGroup = 0;
+    } else if (fractionLost < 0.03) {
+        level.redDistance = 0;
+        level.xorGroup = 4;
+    } else if (fractionLost < 0.08) {
+        level.redDistance = 1;
+        level.xorGroup = 4;
+    } else if (fractionLost < 0.15) {
+        level.redDistance = 2;
+        level.xorGroup = 3;
+    } else {
+        level.redDistance = 3;
+        level.xorGroup = 2;
+    }
+    return level;
+}
+
+// ----------------------- 接收端 -----------------------
+
+/*
+接收端恢复 + 按时间戳排序的播放缓冲。
+播放延迟随码流所需自动增加：RED 距离 d 需要等 d 帧，XOR 组需要等到组内最后一个包。
+连续 FEC_DELAY_DECAY_FRAMES 帧没有丢失、也没有迟到的主编码时，延迟减 1 帧，
+但不低于这段时间里码流实际需要的等待 (发送端降低冗余度后延迟随之回落)。
+纯媒体流 (非 RED/FEC) 延迟为 0，行为与直接播放相同。
+奇偶包只接受 SSRC 为 fecSsrcFor(媒体 SSRC) 或与媒体 SSRC 相同的，其他 FEC 流 (旧流、别的流) 丢弃。
+给出 bytesPerSample 时，负载长度是播放帧整数倍的包 (ptime 大于播放帧) 入缓冲时按帧拆开。
+
+播放状态属于一个媒体 SSRC：出现新的媒体 SSRC (发送端重启) 时丢弃缓冲、从新流重新定位，
+之后旧 SSRC 的迟到包直接丢弃；同一 SSRC 的时间戳前后跳变超过 FEC_PLAYOUT_FRAMES 帧时也重新定位。
+*/
+class FecPlayout {
+public:
+    enum Source {
+        FRAME_PRIMARY,
+        FRAME_RED,
+        FRAME_XOR
+    };
+
+    FecPlayout(uint8_t redPt, uint8_t fecPt, uint32_t samplesPerFrame, unsigned bytesPerSample = 0) :
+        redPt(redPt), fecPt(fecPt), samplesPerFrame(samplesPerFrame),
+        frameBytes(samplesPerFrame * bytesPerSample), framesPerPacket(1), haveSsrc(false), ssrc(0),
+        haveRetired(false), retiredSsrc(0), started(false), baseTs(0), nextPlay(0), highest(0), delay(0),
+        recentNeed(0), cleanFrames(0), lastSeq(0), lastPacketTs(0), played(0), lost(0), fromRed(0), fromXor(0) {
+        for (int i = 0; i < FEC_PLAYOUT_FRAMES; ++i) {
+            frames[i].valid = false;
+        }
+    }
+
+    // 输入一个完整 RTP 包 (媒体或 FEC)
+    void input(const uint8_t *pkt, size_t len) {
+        RtpHeader h;
+        if (rtpParseHeader(pkt, len, h) == 0) {
+            return;
+        }
+        if (h.payloadType == fecPt) {
+            if (!haveSsrc || (h.ssrc != ssrc && h.ssrc != fecSsrcFor(ssrc))) {
+                return;
+            }
+            // 奇偶包在组内最后一个媒体包之后才发出，至少要等满整组
+            raiseDelay(decoder.addParity(pkt, len) * framesPerPacket);
+        } else {
+            if (!acceptSsrc(h.ssrc)) {
+                return;
+            }
+            decoder.addMedia(pkt, len);
+            handleMedia(pkt, len, FRAME_PRIMARY);
+        }
+        uint8_t rec[RTP_MAX_PACKET];
+        size_t n;
+        while ((n = decoder.recover(rec, sizeof(rec))) > 0) {
+            handleMedia(rec, n, FRAME_XOR);
+        }
+    }
+
+    /**
+     * @brief 取出下一帧.
+     * @return false 表示还没有可播放的帧；concealed 为 true 时该帧丢失，frame 为空.
+     */
+    bool pop(std::vector<uint8_t> &frame, bool *concealed) {
+        if (!started || static_cast<int32_t>(highest - nextPlay) < delay) {
+            return false;
+        }
+        Frame &f = frames[nextPlay % FEC_PLAYOUT_FRAMES];
+        if (f.valid && f.index == nextPlay) {
+            frame.swap(f.data);
+            f.valid = false;
+            *concealed = false;
+            lastSeq = f.packetSeq;
+            lastPacketTs = f.packetTs;
+            if (f.source == FRAME_RED) {
+                ++fromRed;
+            } else if (f.source == FRAME_XOR) {
+                ++fromXor;
+            }
+            if (++cleanFrames >= FEC_DELAY_DECAY_FRAMES) {
+                decayDelay();
+            }
+        } else {
+            frame.clear();
+            *concealed = true;
+            lastSeq = 0;
+            lastPacketTs = baseTs + nextPlay * samplesPerFrame;
+            ++lost;
+            disturbed();
+        }
+        ++played;
+        ++nextPlay;
+        return true;
+    }
+
+    // 最近一次 pop() 取出的帧的 RTP 时间戳
+    uint32_t lastTimestamp() const { return baseTs + (nextPlay - 1) * samplesPerFrame; }
+
+    /*
+    最近一次 pop() 取出的帧最初所在的媒体包的序列号和时间戳，即发送端 packet_sent 和
+    接收端 packet_received 报告的值：一个包拆成的几个播放帧相同，XOR 恢复的帧为恢复出的包头，
+    RED 恢复的帧时间戳为原包的时间戳、序列号未知 (0)。丢失的帧为帧自己的时间戳和 0。
+    */
+    uint16_t lastPacketSeq() const { return lastSeq; }
+    uint32_t lastPacketTimestamp() const { return lastPacketTs; }
+
+    // 当前播放的媒体流 SSRC (不是 FEC 流的 SSRC)
+    uint32_t lastSsrc() const { return ssrc; }
+
+    int getDelayFrames() const { return delay; }
+    uint64_t framesPlayed() const { return played; }
+    uint64_t framesLost() const { return lost; }
+    uint64_t framesFromRed() const { return fromRed; }
+    uint64_t framesFromXor() const { return fromXor; }
+
+private:
+    struct Frame {
+        bool valid;
+        uint32_t index;
+        Source source;
+        uint16_t packetSeq; // 原始媒体包，见 lastPacketSeq()
+        uint32_t packetTs;
+        std::vector<uint8_t> data;
+    };
+
+    // 媒体包的 SSRC 是否属于当前播放的流，新 SSRC 取代当前流
+    bool acceptSsrc(uint32_t s) {
+        if (haveSsrc && s == ssrc) {
+            return true;
+        }
+        if (haveRetired && s == retiredSsrc) {
+            return false;
+        }
+        if (haveSsrc) {
+            retiredSsrc = ssrc;
+            haveRetired = true;
+        }
+        ssrc = s;
+        haveSsrc = true;
+        decoder.reset();
+        started = false;
+        return true;
+    }
+
+    // 以 ts 为第 0 帧重新定位，缓冲里的帧作废
+    void anchor(uint32_t ts) {
+        started = true;
+        baseTs = ts;
+        nextPlay = 0;
+        highest = 0;
+        for (int i = 0; i < FEC_PLAYOUT_FRAMES; ++i) {
+            frames[i].valid = false;
+        }
+    }
+
+    void raiseDelay(int frames) {
+        frames = frames < FEC_PLAYOUT_FRAMES / 2 ? frames : FEC_PLAYOUT_FRAMES / 2;
+        if (frames > recentNeed) {
+            recentNeed = frames;
+        }
+        if (frames > delay) {
+            delay = frames;
+        }
+    }
+
+    // 丢帧或主编码迟到：重新开始计算平稳期
+    void disturbed() {
+        cleanFrames = 0;
+        recentNeed = 0;
+    }
+
+    // 平稳了 FEC_DELAY_DECAY_FRAMES 帧，向码流实际需要的延迟回落一帧
+    void decayDelay() {
+        if (delay > recentNeed) {
+            --delay;
+        }
+        cleanFrames = 0;
+        recentNeed = 0;
+    }
+
+    void handleMedia(const uint8_t *pkt, size_t len, Source source) {
+        RtpHeader h;
+        size_t off = rtpParseHeader(pkt, len, h);
+        if (off == 0) {
+            return;
+        }
+        if (h.payloadType != redPt) {
+            store(h.timestamp, h.seq, pkt + off, len - off, source);
+            return;
+        }
+        RedBlock blocks[RED_MAX_DISTANCE + 1];
+        int n = redDecode(pkt + off, len - off, blocks, RED_MAX_DISTANCE + 1);
+        for (int i = 0; i < n; ++i) {
+            if (blocks[i].tsOffset) {
+                raiseDelay(static_cast<int>(blocks[i].tsOffset / samplesPerFrame));
+            }
+            // 冗余块就是原包的整个负载，原包的序列号在 RED 里没有
+            store(h.timestamp - blocks[i].tsOffset, blocks[i].tsOffset ? 0 : h.seq, blocks[i].data,
+                  blocks[i].len, blocks[i].tsOffset ? FRAME_RED : source);
+        }
+    }
+
+    void store(uint32_t ts, uint16_t seq, const uint8_t *data, size_t len, Source source) {
+        if (frameBytes > 0 && len >= frameBytes && len % frameBytes == 0) {
+            framesPerPacket = static_cast<int>(len / frameBytes);
+            for (size_t off = 0; off < len; off += frameBytes) {
+                storeFrame(ts + static_cast<uint32_t>(off / frameBytes) * samplesPerFrame, ts, seq, data + off,
+                           frameBytes, source);
+            }
+            return;
+        }
+        storeFrame(ts, ts, seq, data, len, source);
+    }
+
+    void storeFrame(uint32_t ts, uint32_t packetTs, uint16_t seq, const uint8_t *data, size_t len, Source source) {
+        if (!started) {
+            anchor(ts);
+        }
+        // 相对下一个待播放帧的位置
+        int32_t dist = static_cast<int32_t>(ts - (baseTs + nextPlay * samplesPerFrame));
+        int32_t window = static_cast<int32_t>(FEC_PLAYOUT_FRAMES * samplesPerFrame);
+        if (dist < -window || dist >= window) {
+            // 时间戳跳变 (发送端重置时间戳或长时间中断)，从这一帧重新开始
+            anchor(ts);
+            dist = 0;
+        }
+        if (dist < 0) {
+            if (source == FRAME_PRIMARY) {
+                disturbed(); // 主编码晚于播放时刻到达
+            }
+            return; // 已经播放过 (或已判定丢失)
+        }
+        uint32_t index = nextPlay + static_cast<uint32_t>(dist) / samplesPerFrame;
+        if (static_cast<int32_t>(index - highest) > 0) {
+            highest = index;
+        }
+        Frame &f = frames[index % FEC_PLAYOUT_FRAMES];
+        if (f.valid && f.index == index) {
+            return;
+        }
+        f.valid = true;
+        f.index = index;
+        f.source = source;
+        f.packetSeq = seq;
+        f.packetTs = packetTs;
+        f.data.assign(data, data + len);
+    }
+
+    uint8_t redPt;
+    uint8_t fecPt;
+    uint32_t samplesPerFrame;
+    size_t frameBytes;   // 0 表示不拆包
+    int framesPerPacket; // 最近一个媒体包含有的播放帧数，XOR 组的等待按包数换算成帧数
+    bool haveSsrc;
+    uint32_t ssrc;       // 当前媒体流
+    bool haveRetired;
+    uint32_t retiredSsrc; // 被取代的上一个媒体流，迟到包丢弃
+    XorFecDecoder decoder;
+    Frame frames[FEC_PLAYOUT_FRAMES];
+    bool started;
+    uint32_t baseTs;
+    uint32_t nextPlay;
+    uint32_t highest;
+    int delay;
+    int recentNeed;  // 本平稳期内码流结构 (RED 距离、XOR 组) 要求的延迟
+    int cleanFrames; // 本平稳期已播放的正常帧数
+    uint16_t lastSeq;
+    uint32_t lastPacketTs;
+    uint64_t played;
+    uint64_t lost;
+    uint64_t fromRed;
+    uint64_t fromXor;
+};
+
+#endif // RTP_FEC_H
@@ -0,0 +1,403 @@
+#include <iostream>
+#include <cstring>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+#include "fec.h"
+
+/*
+有损回环测试：发送端 RED + XOR FEC -> 随机丢包信道 -> 接收端 FecPlayout。
+每个配置输出恢复后的帧比例、RED/XOR 各自恢复的帧数、播放延迟带来的额外时延和带宽开销，
+播放出的每一帧 (包括 RED/XOR 恢复的) 都与发送的内容逐字节比较。
+"adaptive" 行模拟 RTCP RR：每 5 秒把接收端统计的丢包率反馈给 fecLevelForLoss。
+最后检查：
+- 发送端重启 (新 SSRC、时间戳从 0 开始) 后接收端能立即跟上新流；
+- 丢包突发时冗余度和播放延迟升高，之后冗余度降回 0，播放延迟也回落到 0；
+- 另一路媒体流的 XOR 奇偶包混进来时被丢弃，不会"恢复"出错误内容；
+- 40ms 包拆成 10ms 播放帧 (含 RED/XOR 恢复的) 后，每帧报告的原始包时间戳/序列号正确。
+*/
+
+#define SAMPLE_RATE 8000
+#define FRAMES_PER_BUFFER 160
+#define FRAME_MS 20
+#define NUM_FRAMES 30000
+#define MEDIA_PT 0
+#define RED_PT 97
+#define FEC_PT 98
+#define RTCP_INTERVAL_FRAMES 250
+#define MEDIA_SSRC 0x12345678
+
+struct Config {
+    const char *name;
+    int redDistance;
+    int xorGroup;
+    bool adaptive;
+};
+
+struct Result {
+    double delivered;
+    uint64_t fromRed;
+    uint64_t fromXor;
+    int delayFrames;
+    double overhead;
+    uint64_t corrupt;
+};
+
+// 第 i 帧的内容
+static void fillFrame(uint32_t i, uint8_t *frame, size_t len) {
+    for (size_t k = 0; k < len; ++k) {
+        frame[k] = static_cast<uint8_t>(i * 7 + k);
+    }
+}
+
+// 播放出的帧与发送的内容不一致返回 true
+static bool corrupted(const std::vector<uint8_t> &out, uint32_t ts, uint32_t tsBase) {
+    uint8_t expected[FRAMES_PER_BUFFER * sizeof(int16_t)];
+    fillFrame((ts - tsBase) / FRAMES_PER_BUFFER, expected, sizeof(expected));
+    return out.size() != sizeof(expected) || memcmp(out.data(), expected, sizeof(expected)) != 0;
+}
+
+static Result run(const Config &cfg, double lossRate, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::bernoulli_distribution drop(lossRate);
+
+    RedEncoder red(MEDIA_PT);
+    XorFecEncoder xorEnc(FEC_PT, fecSsrcFor(MEDIA_SSRC));
+    red.setDistance(cfg.redDistance);
+    xorEnc.setGroupSize(cfg.xorGroup);
+    FecPlayout playout(RED_PT, FEC_PT, FRAMES_PER_BUFFER);
+
+    uint8_t frame[FRAMES_PER_BUFFER * sizeof(int16_t)];
+    uint8_t payload[RTP_MAX_PACKET];
+    uint8_t pkt[RTP_MAX_PACKET];
+    uint8_t parity[RTP_MAX_PACKET];
+    std::vector<uint8_t> out;
+
+    uint64_t wireBytes = 0;
+    uint64_t sentPackets = 0;
+    uint64_t receivedPackets = 0;
+    uint64_t good = 0;
+    uint64_t corrupt = 0;
+    uint16_t seq = 0;
+
+    for (uint32_t i = 0; i < NUM_FRAMES; ++i) {
+        fillFrame(i, frame, sizeof(frame));
+        uint32_t ts = i * FRAMES_PER_BUFFER;
+
+        RtpHeader h;
+        h.ssrc = MEDIA_SSRC;
+        h.seq = seq++;
+        h.timestamp = ts;
+        size_t n;
+        if (red.getDistance() > 0) {
+            h.payloadType = RED_PT;
+            n = rtpBuildPacket(pkt, sizeof(pkt), h, payload, red.encode(frame, sizeof(frame), ts, payload, sizeof(payload)));
+        } else {
+            h.payloadType = MEDIA_PT;
+            red.encode(frame, sizeof(frame), ts, payload, sizeof(payload)); // 保持历史，方便切换冗余度
+            n = rtpBuildPacket(pkt, sizeof(pkt), h, frame, sizeof(frame));
+        }
+        size_t pn = xorEnc.addMedia(pkt, n, parity, sizeof(parity));
+
+        wireBytes += n + (pn ? pn : 0);
+        sentPackets += pn ? 2 : 1;
+        if (!drop(rng)) {
+            playout.input(pkt, n);
+            ++receivedPackets;
+        }
+        if (pn && !drop(rng)) {
+            playout.input(parity, pn);
+            ++receivedPackets;
+        }
+
+        bool concealed;
+        while (playout.pop(out, &concealed)) {
+            if (!concealed) {
+                ++good;
+                corrupt += corrupted(out, playout.lastTimestamp(), 0);
+            }
+        }
+
+        if (cfg.adaptive && (i + 1) % RTCP_INTERVAL_FRAMES == 0) {
+            double fraction = 1.0 - static_cast<double>(receivedPackets) / sentPackets;
+            FecLevel level = fecLevelForLoss(fraction);
+            red.setDistance(level.redDistance);
+            xorEnc.setGroupSize(level.xorGroup);
+            sentPackets = 0;
+            receivedPackets = 0;
+        }
+    }
+
+    Result r;
+    r.delivered = static_cast<double>(good) / playout.framesPlayed();
+    r.fromRed = playout.framesFromRed();
+    r.fromXor = playout.framesFromXor();
+    r.delayFrames = playout.getDelayFrames();
+    double baseBytes = static_cast<double>(NUM_FRAMES) * (RTP_HEADER_SIZE + sizeof(frame));
+    r.overhead = wireBytes / baseBytes - 1.0;
+    r.corrupt = corrupt;
+    return r;
+}
+
+// 无丢包、RED d=1，发送端在第 500 帧重启：新 SSRC，时间戳回到 0；旧流还有几个迟到包
+static bool restart() {
+    RedEncoder red(MEDIA_PT);
+    red.setDistance(1);
+    FecPlayout playout(RED_PT, FEC_PT, FRAMES_PER_BUFFER);
+    uint8_t frame[FRAMES_PER_BUFFER * sizeof(int16_t)];
+    uint8_t payload[RTP_MAX_PACKET];
+    uint8_t pkt[RTP_MAX_PACKET];
+    std::vector<uint8_t> out;
+    std::vector<std::vector<uint8_t>> late;
+    uint64_t good = 0, concealedAfter = 0, corrupt = 0;
+
+    for (uint32_t i = 0; i < 1000; ++i) {
+        bool second = i >= 500;
+        uint32_t n = second ? i - 500 : i + 1000; // 重启前的时间戳比重启后大
+        if (second && i == 500) {
+            red = RedEncoder(MEDIA_PT);
+            red.setDistance(1);
+        }
+        fillFrame(n, frame, sizeof(frame));
+        RtpHeader h;
+        h.ssrc = second ? 0x2222 : 0x1111;
+        h.seq = static_cast<uint16_t>(n);
+        h.timestamp = n * FRAMES_PER_BUFFER;
+        h.payloadType = RED_PT;
+        size_t len = rtpBuildPacket(pkt, sizeof(pkt), h, payload,
+                                    red.encode(frame, sizeof(frame), h.timestamp, payload, sizeof(payload)));
+        if (i >= 495 && i < 500) {
+            late.emplace_back(pkt, pkt + len); // 重启前最后几个包晚到
+            continue;
+        }
+        playout.input(pkt, len);
+        if (i == 502) {
+            for (const std::vector<uint8_t> &p : late) {
+                playout.input(p.data(), p.size());
+            }
+        }
+        bool concealed;
+        while (playout.pop(out, &concealed)) {
+            if (concealed) {
+                concealedAfter += second;
+                continue;
+            }
+            ++good;
+            if (second && playout.lastSsrc() != 0x2222) {
+                ++corrupt;
+            }
+            corrupt += corrupted(out, playout.lastTimestamp(), 0);
+        }
+    }
+    bool ok = concealedAfter == 0 && corrupt == 0 && good >= 990;
+    std::cout << "sender restart (new SSRC, timestamps from 0): " << good << " frames played, "
+              << concealedAfter << " concealed after restart, " << corrupt << " corrupt -> "
+              << (ok ? "ok" : "FAILED") << std::endl;
+    return ok;
+}
+
+// 前 500 帧 RED d=3 + XOR k=4 且丢 10%，之后冗余关闭、不再丢包，播放延迟应回落到 0
+static bool delayDecay() {
+    std::mt19937 rng(7);
+    std::bernoulli_distribution drop(0.10);
+    RedEncoder red(MEDIA_PT);
+    XorFecEncoder xorEnc(FEC_PT, fecSsrcFor(MEDIA_SSRC));
+    FecPlayout playout(RED_PT, FEC_PT, FRAMES_PER_BUFFER);
+    uint8_t frame[FRAMES_PER_BUFFER * sizeof(int16_t)];
+    uint8_t payload[RTP_MAX_PACKET];
+    uint8_t pkt[RTP_MAX_PACKET];
+    uint8_t parity[RTP_MAX_PACKET];
+    std::vector<uint8_t> out;
+    int peak = 0;
+    uint64_t corrupt = 0;
+    const uint32_t burst = 500, total = burst + FEC_PLAYOUT_FRAMES / 2 * FEC_DELAY_DECAY_FRAMES;
+
+    for (uint32_t i = 0; i < total; ++i) {
+        bool lossy = i < burst;
+        red.setDistance(lossy ? 3 : 0);
+        xorEnc.setGroupSize(lossy ? 4 : 0);
+        fillFrame(i, frame, sizeof(frame));
+        RtpHeader h;
+        h.ssrc = MEDIA_SSRC;
+        h.seq = static_cast<uint16_t>(i);
+        h.timestamp = i * FRAMES_PER_BUFFER;
+        size_t len = red.encode(frame, sizeof(frame), h.timestamp, payload, sizeof(payload));
+        size_t n;
+        if (red.lastDistance() > 0) {
+            h.payloadType = RED_PT;
+            n = rtpBuildPacket(pkt, sizeof(pkt), h, payload, len);
+        } else {
+            h.payloadType = MEDIA_PT;
+            n = rtpBuildPacket(pkt, sizeof(pkt), h, frame, sizeof(frame));
+        }
+        size_t pn = xorEnc.addMedia(pkt, n, parity, sizeof(parity));
+        if (!lossy || !drop(rng)) {
+            playout.input(pkt, n);
+        }
+        if (pn && !drop(rng)) {
+            playout.input(parity, pn);
+        }
+        bool concealed;
+        while (playout.pop(out, &concealed)) {
+            if (!concealed) {
+                corrupt += corrupted(out, playout.lastTimestamp(), 0);
+            }
+        }
+        if (playout.getDelayFrames() > peak) {
+            peak = playout.getDelayFrames();
+        }
+    }
+    bool ok = peak > 0 && playout.getDelayFrames() == 0 && corrupt == 0;
+    std::cout << "delay decay: " << peak * FRAME_MS << " ms during loss burst, " << playout.getDelayFrames() * FRAME_MS
+              << " ms after " << (total - burst) * FRAME_MS / 1000 << " s clean, " << corrupt << " corrupt -> "
+              << (ok ? "ok" : "FAILED") << std::endl;
+    return ok;
+}
+
+// 另一路流 (不同 SSRC、相同序列号) 的奇偶包混进来，丢掉的媒体包只能由自己的奇偶包恢复
+static bool foreignParity() {
+    const uint32_t otherSsrc = 0x0badf00d;
+    XorFecEncoder own(FEC_PT, fecSsrcFor(MEDIA_SSRC));
+    XorFecEncoder other(FEC_PT, fecSsrcFor(otherSsrc));
+    own.setGroupSize(4);
+    other.setGroupSize(4);
+    FecPlayout playout(RED_PT, FEC_PT, FRAMES_PER_BUFFER);
+    uint8_t frame[FRAMES_PER_BUFFER * sizeof(int16_t)];
+    uint8_t pkt[RTP_MAX_PACKET];
+    uint8_t otherPkt[RTP_MAX_PACKET];
+    uint8_t parity[RTP_MAX_PACKET];
+    std::vector<uint8_t> out;
+    uint64_t good = 0, corrupt = 0;
+
+    for (uint32_t i = 0; i < 1000; ++i) {
+        RtpHeader h;
+        h.payloadType = MEDIA_PT;
+        h.seq = static_cast<uint16_t>(i);
+        h.timestamp = i * FRAMES_PER_BUFFER;
+        h.ssrc = otherSsrc;
+        memset(frame, 0xee, sizeof(frame));
+        size_t on = rtpBuildPacket(otherPkt, sizeof(otherPkt), h, frame, sizeof(frame));
+        size_t opn = other.addMedia(otherPkt, on, parity, sizeof(parity));
+        if (opn) {
+            playout.input(parity, opn); // 别的流的奇偶包先到
+        }
+
+        h.ssrc = MEDIA_SSRC;
+        fillFrame(i, frame, sizeof(frame));
+        size_t n = rtpBuildPacket(pkt, sizeof(pkt), h, frame, sizeof(frame));
+        size_t pn = own.addMedia(pkt, n, parity, sizeof(parity));
+        if (i % 8 != 3) {
+            playout.input(pkt, n);
+        }
+        if (pn) {
+            playout.input(parity, pn);
+        }
+        bool concealed;
+        while (playout.pop(out, &concealed)) {
+            if (!concealed) {
+                ++good;
+                corrupt += corrupted(out, playout.lastTimestamp(), 0);
+            }
+        }
+    }
+    bool ok = corrupt == 0 && playout.framesFromXor() > 0;
+    std::cout << "foreign parity stream: " << good << " frames played, " << playout.framesFromXor()
+              << " recovered by own XOR, " << corrupt << " corrupt -> " << (ok ? "ok" : "FAILED") << std::endl;
+    return ok;
+}
+
+// 探针的连接键：每个播放帧都能找回发出它的那个媒体包
+static bool packetKeys() {
+    const uint32_t frameSamples = FRAMES_PER_BUFFER / 2;  // 10ms 播放帧
+    const uint32_t packetSamples = frameSamples * 4;      // 40ms 包
+    const uint16_t seqBase = 1000;
+    RedEncoder red(MEDIA_PT);
+    XorFecEncoder xorEnc(FEC_PT, fecSsrcFor(MEDIA_SSRC));
+    red.setDistance(1);
+    xorEnc.setGroupSize(4);
+    FecPlayout playout(RED_PT, FEC_PT, frameSamples, sizeof(int16_t));
+    uint8_t frame[packetSamples * sizeof(int16_t)];
+    uint8_t payload[RTP_MAX_PACKET];
+    uint8_t pkt[RTP_MAX_PACKET];
+    uint8_t parity[RTP_MAX_PACKET];
+    std::vector<uint8_t> out;
+    uint64_t good = 0, wrongTs = 0, wrongSeq = 0, unknownSeq = 0;
+
+    for (uint32_t i = 0; i < 1000; ++i) {
+        RtpHeader h;
+        h.payloadType = RED_PT;
+        h.seq = static_cast<uint16_t>(seqBase + i);
+        h.timestamp = i * packetSamples;
+        h.ssrc = MEDIA_SSRC;
+        memset(frame, static_cast<int>(i), sizeof(frame));
+        size_t n = rtpBuildPacket(pkt, sizeof(pkt), h, payload,
+                                  red.encode(frame, sizeof(frame), h.timestamp, payload, sizeof(payload)));
+        size_t pn = xorEnc.addMedia(pkt, n, parity, sizeof(parity));
+        // 3 只能由 RED 或 XOR 恢复，7 的 RED 副本在 8 里也丢了，只能由 XOR 恢复
+        if (i % 10 != 3 && i % 10 != 7 && i % 10 != 8) {
+            playout.input(pkt, n);
+        }
+        if (pn) {
+            playout.input(parity, pn);
+        }
+        bool concealed;
+        while (playout.pop(out, &concealed)) {
+            if (concealed) {
+                continue;
+            }
+            ++good;
+            uint32_t packet = playout.lastTimestamp() / packetSamples;
+            wrongTs += playout.lastPacketTimestamp() != packet * packetSamples;
+            if (playout.lastPacketSeq() == 0) {
+                ++unknownSeq; // RED 恢复的帧
+            } else {
+                wrongSeq += playout.lastPacketSeq() != static_cast<uint16_t>(seqBase + packet);
+            }
+        }
+    }
+    bool ok = wrongTs == 0 && wrongSeq == 0 && unknownSeq > 0 && playout.framesFromXor() > 0;
+    std::cout << "packet keys for split frames: " << good << " frames, " << wrongTs << " wrong ts, " << wrongSeq
+              << " wrong seq, " << unknownSeq << " from RED without seq -> " << (ok ? "ok" : "FAILED") << std::endl;
+    return ok;
+}
+
+int main() {
+    const Config configs[] = {
+        {"none", 0, 0, false},
+        {"red d=1", 1, 0, false},
+        {"red d=2", 2, 0, false},
+        {"xor k=4", 0, 4, false},
+        {"red d=1 + xor k=4", 1, 4, false},
+        {"adaptive", 0, 0, true},
+    };
+    const double losses[] = {0.01, 0.03, 0.05, 0.10, 0.20};
+
+    std::cout << std::left << std::setw(20) << "config" << std::setw(8) << "loss"
+              << std::setw(12) << "delivered" << std::setw(10) << "by RED" << std::setw(10) << "by XOR"
+              << std::setw(14) << "added delay" << std::setw(10) << "overhead" << "corrupt" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+
+    uint64_t corrupt = 0;
+    for (const Config &cfg : configs) {
+        for (double loss : losses) {
+            Result r = run(cfg, loss, 42);
+            corrupt += r.corrupt;
+            std::cout << std::setw(20) << cfg.name
+                      << std::setw(8) << loss * 100
+                      << std::setw(12) << r.delivered * 100
+                      << std::setw(10) << r.fromRed
+                      << std::setw(10) << r.fromXor
+                      << std::setw(14) << r.delayFrames * FRAME_MS
+                      << std::setw(10) << r.overhead * 100 << r.corrupt << std::endl;
+        }
+    }
+    std::cout << "(loss/delivered/overhead in %, added delay in ms, corrupt = played frames differing from sent)"
+              << std::endl;
+
+    bool ok = restart();
+    ok = delayDecay() && ok;
+    ok = foreignParity() && ok;
+    ok = packetKeys() && ok;
+    return corrupt == 0 && ok ? 0 : 1;
+}
@@ -0,0 +1,366 @@
+#ifndef RTP_G722_H
+#define RTP_G722_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/*
+G.722 宽带编解码 (16kHz，64/56/48 kbit/s)。
+
+结构：QMF 把 16kHz 输入分成低/高两个 8kHz 子带，低带 6 位、高带 2 位 ADPCM，一个样本对一个字节。
+- QMF 是 24 抽头整数 FIR，逐帧先整体做分析 (编码) 或最后整体做合成 (解码)，
+  在输出样本方向上按向量计算，整数运算与逐样本的参考实现位精确一致；
+- ADPCM 只能逐样本递推，状态全部用 int16 存放 (参考实现的取值本来就在 16 位内)，
+  一路编码器或解码器约 140 字节。
+
+RTP (RFC 3551 4.5.2)：静态负载类型 9，SDP 写作 G722/8000。由于历史原因 RTP 时钟按 8000Hz 计，
+实际采样率是 16000Hz：20ms 一帧是 320 个采样、160 字节，时间戳只加 160。
+*/
+
+#define G722_PAYLOAD_TYPE 9
+#define G722_SAMPLE_RATE 16000
+#define G722_RTP_CLOCK_RATE 8000
+#define G722_QMF_HISTORY 11
+#define G722_CHUNK 160 // 一次做 QMF 的样本对数
+
+#if defined(__AVX2__)
+#define G722_LANES 8
+#else
+#define G722_LANES 4
+#endif
+
+typedef int32_t G722Vec __attribute__((vector_size(G722_LANES * sizeof(int32_t))));
+
+// 一帧 (ms) 的负载字节数，也是编码器消耗的样本对数
+inline size_t g722PayloadBytes(unsigned ms) { return ms * G722_SAMPLE_RATE / 1000 / 2; }
+
+// 16kHz 采样数对应的 RTP 时间戳增量
+inline uint32_t g722TimestampIncrement(size_t samples) { return static_cast<uint32_t>(samples / 2); }
+
+namespace g722 {
+
+static const int16_t qmfCoeffs[12] = {3, -11, 12, 32, -210, 951, 3876, -805, 362, -156, 53, -11};
+
+static const int16_t q6[32] = {
+    0, 35, 72, 110, 150, 190, 233, 276, 323, 370, 422, 473, 530, 587, 650, 714,
+    786, 858, 940, 1023, 1121, 1219, 1339, 1458, 1612, 1765, 1980, 2195, 2557, 2919, 0, 0};
+static const int8_t iln[32] = {
+    0, 63, 62, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19,
+    18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 0};
+static const int8_t ilp[32] = {
+    0, 61, 60, 59, 58, 57, 56, 55, 54, 53, 52, 51, 50, 49, 48, 47,
+    46, 45, 44, 43, 42, 41, 40, 39, 38, 37, 36, 35, 34, 33, 32, 0};
+static const int16_t wl[8] = {-60, -30, 58, 172, 334, 538, 1198, 3042};
+static const int8_t rl42[16] = {0, 7, 6, 5, 4, 3, 2, 1, 7, 6, 5, 4, 3, 2, 1, 0};
+static const int16_t ilb[32] = {
+    2048, 2093, 2139, 2186, 2233, 2282, 2332, 2383, 2435, 2489, 2543, 2599, 2656, 2714, 2774, 2834,
+    2896, 2960, 3025, 3091, 3158, 3228, 3298, 3371, 3444, 3520, 3597, 3676, 3756, 3838, 3922, 4008};
+static const int16_t qm4[16] = {
+    0, -20456, -12896, -8968, -6288, -4240, -2584, -1200, 20456, 12896, 8968, 6288, 4240, 2584, 1200, 0};
+static const int16_t qm5[32] = {
+    -280, -280, -23352, -17560, -14120, -11664, -9752, -8184, -6864, -5712, -4696, -3784, -2960, -2208, -1520, -880,
+    23352, 17560, 14120, 11664, 9752, 8184, 6864, 5712, 4696, 3784, 2960, 2208, 1520, 880, 280, -280};
+static const int16_t qm6[64] = {
+    -136, -136, -136, -136, -24808, -21904, -19008, -16704, -14984, -13512, -12280, -11192, -10232, -9360, -8576, -7856,
+    -7192, -6576, -6000, -5456, -4944, -4464, -4008, -3576, -3168, -2776, -2400, -2032, -1688, -1360, -1040, -728,
+    24808, 21904, 19008, 16704, 14984, 13512, 12280, 11192, 10232, 9360, 8576, 7856, 7192, 6576, 6000, 5456,
+    4944, 4464, 4008, 3576, 3168, 2776, 2400, 2032, 1688, 1360, 1040, 728, 432, 136, -432, -136};
+static const int16_t qm2[4] = {-7408, -1616, 7408, 1616};
+static const int8_t ihn[3] = {0, 1, 0};
+static const int8_t ihp[3] = {0, 3, 2};
+static const int16_t wh[3] = {0, -214, 798};
+static const int8_t rh2[4] = {2, 1, 2, 1};
+
+inline int16_t saturate(int v) {
+    return static_cast<int16_t>(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+}
+
+// 一个子带的 ADPCM 状态 (参考实现里的 r/p/a 只保留延迟 1、2 的值)
+struct Band {
+    int16_t s, sp, sz;
+    int16_t r1, r2;
+    int16_t p1, p2;
+    int16_t a1, a2;
+    int16_t d[6];  // d1..d6
+    int16_t b[6];  // b1..b6
+    int16_t nb;
+    int16_t det;
+
+    void reset(int16_t initialDet) {
+        memset(this, 0, sizeof(*this));
+        det = initialDet;
+    }
+
+    // 对数尺度因子 (LOGSCL/LOGSCH + SCALEL/SCALEH)
+    void adaptScale(int w, int nbMax, int shiftBase) {
+        int n = (nb * 127 >> 7) + w;
+        nb = static_cast<int16_t>(n < 0 ? 0 : (n > nbMax ? nbMax : n));
+        int wd1 = (nb >> 6) & 31;
+        int wd2 = shiftBase - (nb >> 11);
+        int wd3 = wd2 < 0 ? ilb[wd1] << -wd2 : ilb[wd1] >> wd2;
+        det = static_cast<int16_t>(wd3 << 2);
+    }
+
+    // 预测器更新 (Block 4: RECONS, PARREC, UPPOL2, UPPOL1, UPZERO, DELAYA, FILTEP, FILTEZ, PREDIC)
+    void update(int dq) {
+        int r0 = saturate(s + dq);
+        int p0 = saturate(sz + dq);
+
+        int sg0 = p0 >> 15;
+        int sg1 = p1 >> 15;
+        int sg2 = p2 >> 15;
+        int wd1 = saturate(a1 << 2);
+        int wd2 = sg0 == sg1 ? -wd1 : wd1;
+        if (wd2 > 32767) {
+            wd2 = 32767;
+        }
+        int wd3 = (wd2 >> 7) + (sg0 == sg2 ? 128 : -128);
+        wd3 += (a2 * 32512) >> 15;
+        int ap2 = wd3 > 12288 ? 12288 : (wd3 < -12288 ? -12288 : wd3);
+
+        wd1 = sg0 == sg1 ? 192 : -192;
+        wd2 = (a1 * 32640) >> 15;
+        int ap1 = saturate(wd1 + wd2);
+        wd3 = saturate(15360 - ap2);
+        ap1 = ap1 > wd3 ? wd3 : (ap1 < -wd3 ? -wd3 : ap1);
+
+        wd1 = dq == 0 ? 0 : 128;
+        int sgd = dq >> 15;
+        for (int i = 0; i < 6; ++i) {
+            wd2 = (d[i] >> 15) == sgd ? wd1 : -wd1;
+            wd3 = (b[i] * 32640) >> 15;
+            b[i] = saturate(wd2 + wd3);
+        }
+        for (int i = 5; i > 0; --i) {
+            d[i] = d[i - 1];
+        }
+        d[0] = static_cast<int16_t>(dq);
+        r2 = r1;
+        r1 = static_cast<int16_t>(r0);
+        p2 = p1;
+        p1 = static_cast<int16_t>(p0);
+        a2 = static_cast<int16_t>(ap2);
+        a1 = static_cast<int16_t>(ap1);
+
+        wd1 = (a1 * saturate(r1 + r1)) >> 15;
+        wd2 = (a2 * saturate(r2 + r2)) >> 15;
+        sp = saturate(wd1 + wd2);
+
+        int z = 0;
+        for (int i = 0; i < 6; ++i) {
+            z += (b[i] * saturate(d[i] + d[i])) >> 15;
+        }
+        sz = saturate(z);
+        s = saturate(sp + sz);
+    }
+};
+
+/**
+ * @brief QMF 的两路 12 抽头点积，按输出样本方向向量化.
+ *
+ * e/o 是偶/奇相位序列，前面带 G722_QMF_HISTORY 个历史样本；对每个 k：
+ *   sumE[k] = Σ e[k + i] * c[i]，sumO[k] = Σ o[k + i] * c[11 - i]
+ */
+inline void qmfDot(const int32_t *e, const int32_t *o, size_t n, int32_t *sumE, int32_t *sumO) {
+    size_t whole = n - n % G722_LANES;
+    for (size_t k = 0; k < whole; k += G722_LANES) {
+        G722Vec se = {};
+        G722Vec so = {};
+        for (int i = 0; i < 12; ++i) {
+            G722Vec ve, vo;
+            memcpy(&ve, e + k + i, sizeof(ve));
+            memcpy(&vo, o + k + i, sizeof(vo));
+            se += ve * static_cast<int32_t>(qmfCoeffs[i]);
+            so += vo * static_cast<int32_t>(qmfCoeffs[11 - i]);
+        }
+        memcpy(sumE + k, &se, sizeof(se));
+        memcpy(sumO + k, &so, sizeof(so));
+    }
+    for (size_t t = 0; t < n % G722_LANES; ++t) {
+        size_t k = whole + t;
+        int32_t se = 0;
+        int32_t so = 0;
+        for (int i = 0; i < 12; ++i) {
+            se += e[k + i] * qmfCoeffs[i];
+            so += o[k + i] * qmfCoeffs[11 - i];
+        }
+        sumE[k] = se;
+        sumO[k] = so;
+    }
+}
+
+} // namespace g722
+
+class G722Encoder {
+public:
+    G722Encoder() { reset(); }
+
+    void reset() {
+        low.reset(32);
+        high.reset(8);
+        memset(histE, 0, sizeof(histE));
+        memset(histO, 0, sizeof(histO));
+    }
+
+    /**
+     * @brief 编码 n 个 16kHz 采样 (n 为偶数)，输出 n / 2 个字节.
+     * @return 输出字节数.
+     */
+    size_t encode(const int16_t *pcm, size_t n, uint8_t *out) {
+        size_t pairs = n / 2;
+        for (size_t done = 0; done < pairs; done += G722_CHUNK) {
+            size_t m = pairs - done < G722_CHUNK ? pairs - done : G722_CHUNK;
+            int32_t e[G722_QMF_HISTORY + G722_CHUNK];
+            int32_t o[G722_QMF_HISTORY + G722_CHUNK];
+            for (int i = 0; i < G722_QMF_HISTORY; ++i) {
+                e[i] = histE[i];
+                o[i] = histO[i];
+            }
+            const int16_t *in = pcm + 2 * done;
+            for (size_t k = 0; k < m; ++k) {
+                e[G722_QMF_HISTORY + k] = in[2 * k];
+                o[G722_QMF_HISTORY + k] = in[2 * k + 1];
+            }
+            int32_t sumOdd[G722_CHUNK];
+            int32_t sumEven[G722_CHUNK];
+            g722::qmfDot(e, o, m, sumOdd, sumEven);
+            for (int i = 0; i < G722_QMF_HISTORY; ++i) {
+                histE[i] = static_cast<int16_t>(e[m + i]);
+                histO[i] = static_cast<int16_t>(o[m + i]);
+            }
+            for (size_t k = 0; k < m; ++k) {
+                int xlow = (sumEven[k] + sumOdd[k]) >> 14;
+                int xhigh = (sumEven[k] - sumOdd[k]) >> 14;
+                out[done + k] = encodeBands(xlow, xhigh);
+            }
+        }
+        return pairs;
+    }
+
+    // 不经过 QMF，直接编码一对子带样本 (ITU 测试序列用)
+    uint8_t encodeBands(int xlow, int xhigh) {
+        using namespace g722;
+        // 低带：6 位量化
+        int el = saturate(xlow - low.s);
+        int wd = el >= 0 ? el : -(el + 1);
+        int i = 1;
+        for (; i < 30; ++i) {
+            if (wd < ((q6[i] * low.det) >> 12)) {
+                break;
+            }
+        }
+        int ilow = el < 0 ? iln[i] : ilp[i];
+        int ril = ilow >> 2;
+        int dlow = (low.det * qm4[ril]) >> 15;
+        low.adaptScale(wl[rl42[ril]], 18432, 8);
+        low.update(dlow);
+
+        // 高带：2 位量化
+        int eh = saturate(xhigh - high.s);
+        wd = eh >= 0 ? eh : -(eh + 1);
+        int mih = wd >= ((564 * high.det) >> 12) ? 2 : 1;
+        int ihigh = eh < 0 ? ihn[mih] : ihp[mih];
+        int dhigh = (high.det * qm2[ihigh]) >> 15;
+        high.adaptScale(wh[rh2[ihigh]], 22528, 10);
+        high.update(dhigh);
+
+        return static_cast<uint8_t>((ihigh << 6) | ilow);
+    }
+
+private:
+    g722::Band low;
+    g722::Band high;
+    int16_t histE[G722_QMF_HISTORY];
+    int16_t histO[G722_QMF_HISTORY];
+};
+
+class G722Decoder {
+public:
+    // mode 1/2/3 = 64/56/48 kbit/s：每字节低带只用高 6/5/4 位
+    explicit G722Decoder(int mode = 1) : mode(static_cast<int8_t>(mode)) { reset(); }
+
+    void reset() {
+        low.reset(32);
+        high.reset(8);
+        memset(histE, 0, sizeof(histE));
+        memset(histO, 0, sizeof(histO));
+    }
+
+    /**
+     * @brief 解码 n 个字节，输出 2n 个 16kHz 采样.
+     * @return 输出采样数.
+     */
+    size_t decode(const uint8_t *data, size_t n, int16_t *pcm) {
+        for (size_t done = 0; done < n; done += G722_CHUNK) {
+            size_t m = n - done < G722_CHUNK ? n - done : G722_CHUNK;
+            int32_t e[G722_QMF_HISTORY + G722_CHUNK];
+            int32_t o[G722_QMF_HISTORY + G722_CHUNK];
+            for (int i = 0; i < G722_QMF_HISTORY; ++i) {
+                e[i] = histE[i];
+                o[i] = histO[i];
+            }
+            for (size_t k = 0; k < m; ++k) {
+                int rlow, rhigh;
+                decodeBands(data[done + k], &rlow, &rhigh);
+                e[G722_QMF_HISTORY + k] = rlow + rhigh;
+                o[G722_QMF_HISTORY + k] = rlow - rhigh;
+            }
+            int32_t sum2[G722_CHUNK];
+            int32_t sum1[G722_CHUNK];
+            g722::qmfDot(e, o, m, sum2, sum1);
+            for (int i = 0; i < G722_QMF_HISTORY; ++i) {
+                histE[i] = static_cast<int16_t>(e[m + i]);
+                histO[i] = static_cast<int16_t>(o[m + i]);
+            }
+            int16_t *out = pcm + 2 * done;
+            for (size_t k = 0; k < m; ++k) {
+                out[2 * k] = g722::saturate(sum1[k] >> 11);
+                out[2 * k + 1] = g722::saturate(sum2[k] >> 11);
+            }
+        }
+        return 2 * n;
+    }
+
+    // 解码一个字节到两个子带的重建信号 (不经过 QMF，ITU 测试序列用)
+    void decodeBands(uint8_t code, int *rlow, int *rhigh) {
+        using namespace g722;
+        int ilow;
+        int wd2;
+        if (mode == 1) {
+            ilow = code & 0x3f;
+            wd2 = qm6[ilow];
+            ilow >>= 2;
+        } else if (mode == 2) {
+            ilow = (code >> 1) & 0x1f;
+            wd2 = qm5[ilow];
+            ilow >>= 1;
+        } else {
+            ilow = (code >> 2) & 0x0f;
+            wd2 = qm4[ilow];
+        }
+        int ihigh = (code >> 6) & 0x03;
+
+        // 低带：完整码字重建输出，高 4 位驱动自适应 (与编码器一致)
+        int r = low.s + ((low.det * wd2) >> 15);
+        *rlow = r > 16383 ? 16383 : (r < -16384 ? -16384 : r);
+        int dlow = (low.det * qm4[ilow]) >> 15;
+        low.adaptScale(wl[rl42[ilow]], 18432, 8);
+        low.update(dlow);
+
+        int dhigh = (high.det * qm2[ihigh]) >> 15;
+        r = dhigh + high.s;
+        *rhigh = r > 16383 ? 16383 : (r < -16384 ? -16384 : r);
+        high.adaptScale(wh[rh2[ihigh]], 22528, 10);
+        high.update(dhigh);
+    }
+
+private:
+    g722::Band low;
+    g722::Band high;
+    int16_t histE[G722_QMF_HISTORY];
+    int16_t histO[G722_QMF_HISTORY];
+    int8_t mode;
+};
+
+#endif // RTP_G722_H
@@ -0,0 +1,193 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "g722.h"
+
+/*
+用 ITU-T G.722 测试序列 (G.722 附录 II 的 T1C*.XMT、T2R*.COD、T3L*.RC*、T3H*.RC0 等) 验证位精确。
+测试序列不随代码发布，需要自行下载后在命令行给出路径。
+
+序列文件是 16 位字：
+- 编码器输入和解码器输出是左对齐的子带信号，编码时右移 1 位送入两个子带，解码输出左移 1 位比较
+  (与 spandsp 的 itu_test_mode 相同；复位状态下的手算已知答案在 bench_g722 里)；
+- 码字文件每个字的低 8 位是码字。
+序列绕过 QMF，只测两个子带的 ADPCM。
+-be 按大端读，-skip N 跳过文件开头 N 个字。
+
+另外可以用其他实现生成的 16kHz PCM 和码流做整体 (含 QMF) 对比：
+  full-enc <pcm> <g722>  pcm 为本机字节序 int16，g722 为每字节一个码字
+  full-dec <g722> <pcm> [mode]
+
+用法:
+  g722_vectors [-be] [-skip N] enc <输入.xmt> <期望.cod>
+  g722_vectors [-be] [-skip N] dec <mode 1-3> <输入.cod> <期望低带.rcN> <期望高带.rc0>
+  g722_vectors full-enc <输入.pcm> <期望.g722>
+  g722_vectors full-dec <输入.g722> <期望.pcm> [mode]
+*/
+
+static bool bigEndian = false;
+static size_t skipWords = 0;
+
+static bool readFile(const char *path, std::vector<uint8_t> &data) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        data.insert(data.end(), buf, buf + n);
+    }
+    fclose(f);
+    return true;
+}
+
+static bool readWords(const char *path, std::vector<int16_t> &words) {
+    std::vector<uint8_t> data;
+    if (!readFile(path, data)) {
+        return false;
+    }
+    for (size_t i = 2 * skipWords; i + 1 < data.size(); i += 2) {
+        uint16_t w = bigEndian ? (data[i] << 8 | data[i + 1]) : (data[i + 1] << 8 | data[i]);
+        words.push_back(static_cast<int16_t>(w));
+    }
+    return true;
+}
+
+// 逐个比较，打印前几个不一致的位置
+static size_t compare(const char *what, const std::vector<int> &got, const std::vector<int16_t> &expected) {
+    size_t n = got.size() < expected.size() ? got.size() : expected.size();
+    size_t bad = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (got[i] != expected[i]) {
+            if (bad < 5) {
+                std::cout << "  " << what << "[" << i << "]: got " << got[i] << ", expected " << expected[i]
+                          << std::endl;
+            }
+            ++bad;
+        }
+    }
+    std::cout << what << ": " << n << " words, " << bad << " mismatches";
+    if (got.size() != expected.size()) {
+        std::cout << " (length " << got.size() << " vs " << expected.size() << ")";
+    }
+    std::cout << std::endl;
+    return bad;
+}
+
+static int encodeVectors(const char *input, const char *expected) {
+    std::vector<int16_t> in, cod;
+    if (!readWords(input, in) || !readWords(expected, cod)) {
+        return 2;
+    }
+    G722Encoder enc;
+    std::vector<int> got;
+    for (int16_t x : in) {
+        got.push_back(enc.encodeBands(x >> 1, x >> 1));
+    }
+    for (int16_t &c : cod) {
+        c &= 0xff;
+    }
+    return compare("code", got, cod) ? 1 : 0;
+}
+
+static int decodeVectors(int mode, const char *input, const char *expectedLow, const char *expectedHigh) {
+    std::vector<int16_t> cod, low, high;
+    if (!readWords(input, cod) || !readWords(expectedLow, low) || !readWords(expectedHigh, high)) {
+        return 2;
+    }
+    G722Decoder dec(mode);
+    std::vector<int> gotLow, gotHigh;
+    for (int16_t c : cod) {
+        int rlow, rhigh;
+        dec.decodeBands(static_cast<uint8_t>(c), &rlow, &rhigh);
+        gotLow.push_back(static_cast<int16_t>(rlow << 1));
+        gotHigh.push_back(static_cast<int16_t>(rhigh << 1));
+    }
+    size_t bad = compare("low", gotLow, low);
+    bad += compare("high", gotHigh, high);
+    return bad ? 1 : 0;
+}
+
+static int encodeStream(const char *input, const char *expected) {
+    std::vector<uint8_t> raw, ref;
+    if (!readFile(input, raw) || !readFile(expected, ref)) {
+        return 2;
+    }
+    std::vector<int16_t> pcm(raw.size() / 2);
+    memcpy(pcm.data(), raw.data(), pcm.size() * 2);
+    std::vector<uint8_t> code(pcm.size() / 2);
+    G722Encoder enc;
+    enc.encode(pcm.data(), code.size() * 2, code.data());
+    std::vector<int> got(code.begin(), code.end());
+    std::vector<int16_t> want(ref.begin(), ref.end());
+    return compare("code", got, want) ? 1 : 0;
+}
+
+static int decodeStream(const char *input, const char *expected, int mode) {
+    std::vector<uint8_t> code, raw;
+    if (!readFile(input, code) || !readFile(expected, raw)) {
+        return 2;
+    }
+    std::vector<int16_t> want(raw.size() / 2);
+    memcpy(want.data(), raw.data(), want.size() * 2);
+    std::vector<int16_t> pcm(code.size() * 2);
+    G722Decoder dec(mode);
+    dec.decode(code.data(), code.size(), pcm.data());
+    std::vector<int> got(pcm.begin(), pcm.end());
+    return compare("pcm", got, want) ? 1 : 0;
+}
+
+static int usage() {
+    std::cerr << "usage: g722_vectors [-be] [-skip N] enc <in.xmt> <expected.cod>" << std::endl
+              << "       g722_vectors [-be] [-skip N] dec <mode 1-3> <in.cod> <expected.rcN> <expected-high.rc0>"
+              << std::endl
+              << "       g722_vectors full-enc <in.pcm> <expected.g722>" << std::endl
+              << "       g722_vectors full-dec <in.g722> <expected.pcm> [mode]" << std::endl;
+    return 2;
+}
+
+int main(int argc, char *argv[]) {
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-'; ++i) {
+        if (strcmp(argv[i], "-be") == 0) {
+            bigEndian = true;
+        } else if (strcmp(argv[i], "-skip") == 0 && i + 1 < argc) {
+            skipWords = strtoul(argv[++i], nullptr, 10);
+        } else {
+            return usage();
+        }
+    }
+    int left = argc - i;
+    if (left < 1) {
+        return usage();
+    }
+    const char *cmd = argv[i];
+    char **arg = argv + i + 1;
+
+    if (strcmp(cmd, "enc") == 0 && left == 3) {
+        return encodeVectors(arg[0], arg[1]);
+    }
+    if (strcmp(cmd, "dec") == 0 && left == 5) {
+        int mode = atoi(arg[0]);
+        if (mode < 1 || mode > 3) {
+            return usage();
+        }
+        return decodeVectors(mode, arg[1], arg[2], arg[3]);
+    }
+    if (strcmp(cmd, "full-enc") == 0 && left == 3) {
+        return encodeStream(arg[0], arg[1]);
+    }
+    if (strcmp(cmd, "full-dec") == 0 && (left == 3 || left == 4)) {
+        int mode = left == 4 ? atoi(arg[2]) : 1;
+        if (mode < 1 || mode > 3) {
+            return usage();
+        }
+        return decodeStream(arg[0], arg[1], mode);
+    }
+    return usage();
+}
@@ -0,0 +1,357 @@
+#include <iostream>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <jrtplib3/rtpsession.h>
+#include <jrtplib3/rtppacket.h>
+#include <jrtplib3/rtpipv4address.h>
+#include <jrtplib3/rtpudpv4transmitter.h>
+#include <jrtplib3/rtpsessionparams.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+
+#include "latency_probe.h"
+#include "ptime.h"
+
+using namespace jrtplib;
+
+/*
+无需声卡的回环时延探测。
+采集/播放设备用定时线程模拟 (和 PortAudio 一样每 10ms 一块，播放缓冲写满时阻塞)，
+发送和接收循环照搬 sender.cc / receiver.cc 的写法，经过真实的 UDP 回环。
+
+每个包的采集时间戳放在 RTP 头扩展里，各阶段打点：
+  capture   包中第一个采样被采集
+  ready     凑满一个 ptime 的最后一块采集就绪 (sender.cc 中 Pa_ReadStream 返回)
+  sent      PtimeAggregator 出包后发出 (sender.cc 中读阻塞即节拍，没有 usleep)
+  dequeued  接收循环 Poll 后取出 (receiver.cc 中 usleep(10000) 轮询)
+  written   Pa_WriteStream 返回 (receiver.cc 按 10ms 播放帧写，播放缓冲满时阻塞)
+  played    该帧第一个采样被设备消费
+包拆成 10ms 块后，后面的块按各自在包内的偏移计时。
+另外每 2 秒在采集信号中注入一次 chirp，在输出端用互相关找到它，得到独立的 mouth-to-ear 时延。
+
+用法: latency_probe [秒数] [read|usleep] [ptime_ms]
+  read   采集读阻塞即节拍，同现在的 sender.cc (默认)
+  usleep 复现旧版 sender.cc：每发一个包再 usleep(ptime)
+  ptime  10~60ms，默认 20ms
+*/
+
+#define SAMPLE_RATE 8000
+#define FRAMES_PER_BUFFER 80    // 采集/播放块 10ms，同 sender.cc 和 receiver.cc 的播放帧
+#define FRAME_NS 10000000ULL
+#define SEND_PORT 9100
+#define RECV_PORT 9102
+#define DEST_IP "127.0.0.1"
+#define CAPTURE_BUFFER_FRAMES 16   // 输入设备缓冲 160ms，溢出时丢最旧的块
+#define PLAYBACK_BUFFER_FRAMES 8   // 输出设备缓冲 80ms，满时写阻塞
+#define CHIRP_PERIOD_SEC 2
+#define CHIRP_OFFSET_SAMPLES 4000
+
+struct Frame {
+    int16_t samples[FRAMES_PER_BUFFER];
+    uint64_t captureNs;   // 块中第一个采样的采集时刻
+    uint64_t readyNs;     // 块就绪 (采集完成)，接收端不用
+    uint64_t sentNs;
+    uint64_t dequeuedNs;
+    uint64_t writtenNs;
+};
+
+std::atomic<bool> running(true);
+
+static void sleepUntilNs(uint64_t ns) {
+    uint64_t now = probeNowNs();
+    if (ns > now) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(ns - now));
+    }
+}
+
+// 模拟输入设备：每 10ms 产生一块，背景噪声 + 周期性 chirp
+class CaptureDevice {
+public:
+    explicit CaptureDevice(const std::vector<int16_t> &chirp) : chirp(chirp), overflows(0) {}
+
+    void run(uint64_t startNs) {
+        uint32_t noise = 1;
+        uint64_t sampleIndex = 0;
+        for (uint64_t block = 0; running; ++block) {
+            Frame f;
+            f.captureNs = startNs + block * FRAME_NS;
+            for (int i = 0; i < FRAMES_PER_BUFFER; ++i, ++sampleIndex) {
+                noise = noise * 1664525u + 1013904223u;
+                int32_t s = static_cast<int16_t>(noise >> 16) / 64;
+                uint64_t pos = sampleIndex % (CHIRP_PERIOD_SEC * SAMPLE_RATE);
+                if (pos >= CHIRP_OFFSET_SAMPLES && pos < CHIRP_OFFSET_SAMPLES + chirp.size()) {
+                    s += chirp[pos - CHIRP_OFFSET_SAMPLES];
+                }
+                f.samples[i] = static_cast<int16_t>(std::max(-32768, std::min(32767, s)));
+            }
+            sleepUntilNs(f.captureNs + FRAME_NS);
+            f.readyNs = probeNowNs();
+
+            std::lock_guard<std::mutex> lock(m);
+            if (ring.size() >= CAPTURE_BUFFER_FRAMES) {
+                ring.pop_front();
+                ++overflows;
+            }
+            ring.push_back(f);
+            cv.notify_one();
+        }
+        cv.notify_all();
+    }
+
+    // 等价于 Pa_ReadStream
+    bool read(Frame &f) {
+        std::unique_lock<std::mutex> lock(m);
+        cv.wait(lock, [this] { return !ring.empty() || !running; });
+        if (ring.empty()) {
+            return false;
+        }
+        f = ring.front();
+        ring.pop_front();
+        return true;
+    }
+
+    uint64_t overflowCount() {
+        std::lock_guard<std::mutex> lock(m);
+        return overflows;
+    }
+
+private:
+    const std::vector<int16_t> &chirp;
+    std::mutex m;
+    std::condition_variable cv;
+    std::deque<Frame> ring;
+    uint64_t overflows;
+};
+
+// 模拟输出设备：每 10ms 消费一块，缓冲空时播放静音
+class PlaybackDevice {
+public:
+    PlaybackDevice() : underruns(0) {}
+
+    void run(uint64_t startNs, LatencyStats &writtenToPlayed, LatencyStats &total) {
+        for (uint64_t block = 0; running; ++block) {
+            uint64_t playNs = startNs + block * FRAME_NS;
+            sleepUntilNs(playNs);
+            Frame f;
+            bool have = false;
+            {
+                std::lock_guard<std::mutex> lock(m);
+                if (!ring.empty()) {
+                    f = ring.front();
+                    ring.pop_front();
+                    have = true;
+                } else if (started) {
+                    ++underruns;
+                }
+                cv.notify_one();
+            }
+            playTimes.push_back(playNs);
+            if (have) {
+                output.insert(output.end(), f.samples, f.samples + FRAMES_PER_BUFFER);
+                writtenToPlayed.add((playNs - f.writtenNs) / 1e6);
+                total.add((playNs - f.captureNs) / 1e6);
+            } else {
+                output.insert(output.end(), FRAMES_PER_BUFFER, 0);
+            }
+        }
+        cv.notify_all();
+    }
+
+    // 等价于 Pa_WriteStream：缓冲满时阻塞
+    void write(Frame &f) {
+        std::unique_lock<std::mutex> lock(m);
+        cv.wait(lock, [this] { return ring.size() < PLAYBACK_BUFFER_FRAMES || !running; });
+        f.writtenNs = probeNowNs();
+        ring.push_back(f);
+        started = true;
+    }
+
+    uint64_t underrunCount() {
+        std::lock_guard<std::mutex> lock(m);
+        return underruns;
+    }
+
+    // 以下只在 run() 结束后读取
+    std::vector<int16_t> output;
+    std::vector<uint64_t> playTimes; // 第 i 块输出的播放时刻
+
+private:
+    std::mutex m;
+    std::condition_variable cv;
+    std::deque<Frame> ring;
+    bool started = false;
+    uint64_t underruns;
+};
+
+static bool createSession(RTPSession &sess, uint16_t port) {
+    RTPSessionParams sessparams;
+    sessparams.SetOwnTimestampUnit(1.0 / SAMPLE_RATE);
+    RTPUDPv4TransmissionParams transparams;
+    transparams.SetPortbase(port);
+    return sess.Create(sessparams, &transparams) >= 0;
+}
+
+int main(int argc, char *argv[]) {
+    int seconds = argc > 1 ? atoi(argv[1]) : 10;
+    bool usleepPacing = argc > 2 && std::string(argv[2]) == "usleep";
+    unsigned ptime = argc > 3 ? static_cast<unsigned>(atoi(argv[3])) : PTIME_DEFAULT_MS;
+    if (!ptimeValid(ptime)) {
+        std::cerr << "ptime must be " << PTIME_MIN_MS << "-" << PTIME_MAX_MS << " ms in steps of "
+                  << PTIME_FRAME_MS << std::endl;
+        return 1;
+    }
+
+    RTPSession sendSess;
+    RTPSession recvSess;
+    if (!createSession(sendSess, SEND_PORT) || !createSession(recvSess, RECV_PORT)) {
+        std::cerr << "Error creating RTP session!" << std::endl;
+        return 1;
+    }
+    sendSess.AddDestination(RTPIPv4Address(ntohl(inet_addr(DEST_IP)), RECV_PORT));
+
+    std::vector<int16_t> chirp = makeChirp(300, 3400, 0.1, SAMPLE_RATE, 0.5);
+    CaptureDevice capture(chirp);
+    PlaybackDevice playback;
+
+    LatencyStats captureToReady("capture -> ready");
+    LatencyStats readyToSent("ready -> sent");
+    LatencyStats sentToDequeued("sent -> dequeued");
+    LatencyStats dequeuedToWritten("dequeued -> written");
+    LatencyStats writtenToPlayed("written -> played");
+    LatencyStats total("capture -> played");
+
+    uint64_t startNs = probeNowNs() + FRAME_NS;
+    std::thread captureThread(&CaptureDevice::run, &capture, startNs);
+    std::thread playbackThread(&PlaybackDevice::run, &playback, startNs, std::ref(writtenToPlayed), std::ref(total));
+
+    // 发送循环，同 sender.cc：10ms 采集块攒成 ptime 再发
+    std::thread sendThread([&] {
+        Frame f;
+        uint8_t ext[PROBE_EXT_WORDS * 4];
+        PtimeAggregator aggregator(ptime, SAMPLE_RATE, sizeof(int16_t));
+        const uint8_t *payload;
+        size_t payloadLen;
+        uint32_t timestamp;
+        while (capture.read(f)) {
+            aggregator.push(reinterpret_cast<const uint8_t *>(f.samples), sizeof(f.samples));
+            while (aggregator.pop(&payload, &payloadLen, &timestamp)) {
+                // 时间戳从 0 开始按样本推进，直接换算出包中第一个采样的采集时刻
+                uint64_t captureNs = startNs + static_cast<uint64_t>(timestamp) * 1000000000ULL / SAMPLE_RATE;
+                uint64_t sentNs = probeNowNs();
+                probeWriteExtension(ext, captureNs, sentNs);
+                sendSess.SendPacketEx(payload, payloadLen, 0, false,
+                                      static_cast<uint32_t>(payloadLen / sizeof(int16_t)),
+                                      PROBE_EXT_PROFILE, ext, PROBE_EXT_WORDS);
+                captureToReady.add((f.readyNs - captureNs) / 1e6);
+                readyToSent.add((sentNs - f.readyNs) / 1e6);
+                if (usleepPacing) {
+                    usleep(ptime * 1000);
+                }
+            }
+        }
+    });
+
+    // 接收循环，同 receiver.cc
+    std::thread recvThread([&] {
+        while (running) {
+            recvSess.Poll();
+            recvSess.BeginDataAccess();
+            std::vector<Frame> frames;
+            if (recvSess.GotoFirstSourceWithData()) {
+                do {
+                    RTPPacket *packet;
+                    while ((packet = recvSess.GetNextPacket()) != nullptr) {
+                        Frame f;
+                        f.dequeuedNs = probeNowNs();
+                        f.sentNs = 0;
+                        // 同 FecPlayout：按 10ms 播放帧拆开，ptime 不需要事先知道
+                        size_t len = packet->GetPayloadLength();
+                        if (packet->HasExtension() && len > 0 && len % sizeof(f.samples) == 0 &&
+                            probeReadExtension(packet->GetExtensionID(), packet->GetExtensionData(),
+                                               packet->GetExtensionLength(), &f.captureNs, &f.sentNs)) {
+                            for (size_t off = 0; off < len; off += sizeof(f.samples)) {
+                                memcpy(f.samples, packet->GetPayloadData() + off, sizeof(f.samples));
+                                frames.push_back(f);
+                                f.captureNs += FRAME_NS;
+                                f.sentNs = 0; // sent -> dequeued 每个包只算一次
+                            }
+                        }
+                        recvSess.DeletePacket(packet);
+                    }
+                } while (recvSess.GotoNextSourceWithData());
+            }
+            recvSess.EndDataAccess();
+
+            for (Frame &f : frames) {
+                if (f.sentNs) {
+                    sentToDequeued.add((f.dequeuedNs - f.sentNs) / 1e6);
+                }
+                playback.write(f);
+                dequeuedToWritten.add((f.writtenNs - f.dequeuedNs) / 1e6);
+            }
+            usleep(10000);
+        }
+    });
+
+    std::cout << "Probing for " << seconds << " s over UDP loopback, ptime " << ptime << " ms ("
+              << (usleepPacing ? "usleep" : "read") << " pacing)..." << std::endl;
+    sleep(seconds);
+    running = false;
+
+    captureThread.join();
+    sendThread.join();
+    recvThread.join();
+    playbackThread.join();
+
+    sendSess.BYEDestroy(RTPTime(0, 100000), "Bye", 3);
+    recvSess.BYEDestroy(RTPTime(0, 100000), "Bye", 3);
+
+    std::cout << std::endl;
+    LatencyStats::printHeader(std::cout);
+    captureToReady.printRow(std::cout);
+    readyToSent.printRow(std::cout);
+    sentToDequeued.printRow(std::cout);
+    dequeuedToWritten.printRow(std::cout);
+    writtenToPlayed.printRow(std::cout);
+    total.printRow(std::cout);
+    std::cout << "capture overflows: " << capture.overflowCount()
+              << ", playback underruns: " << playback.underrunCount() << std::endl << std::endl;
+    total.printHistogram(std::cout, 5.0);
+
+    // chirp 检测：在注入时刻之后 1 秒内的输出中搜索
+    LatencyStats acoustic("chirp mouth-to-ear");
+    for (uint64_t k = 0;; ++k) {
+        uint64_t injectSample = k * CHIRP_PERIOD_SEC * SAMPLE_RATE + CHIRP_OFFSET_SAMPLES;
+        uint64_t injectNs = startNs + injectSample * 1000000000ULL / SAMPLE_RATE;
+        size_t begin = 0;
+        while (begin < playback.playTimes.size() && playback.playTimes[begin] < injectNs) {
+            ++begin;
+        }
+        if (begin >= playback.playTimes.size()) {
+            break;
+        }
+        begin = begin > 0 ? begin - 1 : 0;
+        size_t from = begin * FRAMES_PER_BUFFER;
+        double score;
+        long pos = findChirp(playback.output, from, from + SAMPLE_RATE, chirp, 0.5, &score);
+        if (pos < 0) {
+            std::cout << "chirp " << k << ": not found" << std::endl;
+            continue;
+        }
+        uint64_t playNs = playback.playTimes[pos / FRAMES_PER_BUFFER] +
+                          (pos % FRAMES_PER_BUFFER) * 1000000000ULL / SAMPLE_RATE;
+        acoustic.add((playNs - injectNs) / 1e6);
+    }
+    std::cout << std::endl;
+    LatencyStats::printHeader(std::cout);
+    acoustic.printRow(std::cout);
+
+    return 0;
+}
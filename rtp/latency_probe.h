@@ -0,0 +1,192 @@
+#ifndef RTP_LATENCY_PROBE_H
+#define RTP_LATENCY_PROBE_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "rtp_packet.h"
+
+/*
+端到端 (mouth-to-ear) 时延测量工具：
+- 采集/发送时间戳放在 RTP 头扩展里 (RFC 8285 一字节格式)，随包一起到达接收端；
+- LatencyStats 记录每个阶段的时延分布；
+- 线性扫频 chirp + 互相关，在输出端找到注入的信号，独立于打点测出总时延。
+*/
+
+#define PROBE_EXT_PROFILE 0xBEDE    // RFC 8285 一字节头扩展
+#define PROBE_EXT_CAPTURE_ID 1      // 扩展元素 ID，需与对端协商
+#define PROBE_EXT_SENT_ID 2
+#define PROBE_EXT_WORDS 5           // 两个 (1 字节头 + 8 字节时间戳)，补齐到 20 字节
+
+inline uint64_t probeNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline void probePutStamp(uint8_t *p, uint8_t id, uint64_t ns) {
+    p[0] = static_cast<uint8_t>((id << 4) | (8 - 1));
+    rtpPut32(p + 1, static_cast<uint32_t>(ns >> 32));
+    rtpPut32(p + 5, static_cast<uint32_t>(ns));
+}
+
+// 生成头扩展数据 (PROBE_EXT_WORDS 个 32 位字)，配合 RTPSession::SendPacketEx 使用
+inline void probeWriteExtension(uint8_t out[PROBE_EXT_WORDS * 4], uint64_t captureNs, uint64_t sentNs) {
+    probePutStamp(out, PROBE_EXT_CAPTURE_ID, captureNs);
+    probePutStamp(out + 9, PROBE_EXT_SENT_ID, sentNs);
+    out[18] = out[19] = 0; // padding
+}
+
+// 从头扩展数据中取出采集/发送时间戳，至少要有采集时间戳
+inline bool probeReadExtension(uint16_t profile, const uint8_t *data, size_t len,
+                               uint64_t *captureNs, uint64_t *sentNs) {
+    if (profile != PROBE_EXT_PROFILE) {
+        return false;
+    }
+    bool found = false;
+    size_t off = 0;
+    while (off < len) {
+        uint8_t id = data[off] >> 4;
+        size_t elen = (data[off] & 0x0f) + 1;
+        if (id == 0) { // padding
+            ++off;
+            continue;
+        }
+        if (id == 15 || off + 1 + elen > len) {
+            break;
+        }
+        if (elen == 8 && (id == PROBE_EXT_CAPTURE_ID || id == PROBE_EXT_SENT_ID)) {
+            uint64_t ns = (static_cast<uint64_t>(rtpGet32(data + off + 1)) << 32) | rtpGet32(data + off + 5);
+            if (id == PROBE_EXT_CAPTURE_ID) {
+                *captureNs = ns;
+                found = true;
+            } else {
+                *sentNs = ns;
+            }
+        }
+        off += 1 + elen;
+    }
+    return found;
+}
+
+// 一个阶段的时延分布 (毫秒)
+class LatencyStats {
+public:
+    explicit LatencyStats(const std::string &name) : name(name) {}
+
+    void add(double ms) { samples.push_back(ms); }
+    size_t count() const { return samples.size(); }
+
+    double percentile(double p) {
+        if (samples.empty()) {
+            return 0;
+        }
+        sortOnce();
+        size_t i = static_cast<size_t>(p / 100.0 * (samples.size() - 1) + 0.5);
+        return samples[i];
+    }
+
+    void printRow(std::ostream &os) {
+        os << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(2)
+           << std::setw(8) << samples.size()
+           << std::setw(9) << percentile(0) << std::setw(9) << percentile(50)
+           << std::setw(9) << percentile(90) << std::setw(9) << percentile(99)
+           << std::setw(9) << percentile(100) << std::endl;
+    }
+
+    static void printHeader(std::ostream &os) {
+        os << std::left << std::setw(22) << "stage (ms)" << std::right
+           << std::setw(8) << "n" << std::setw(9) << "min" << std::setw(9) << "p50"
+           << std::setw(9) << "p90" << std::setw(9) << "p99" << std::setw(9) << "max" << std::endl;
+    }
+
+    // 文本直方图，bucketMs 为桶宽
+    void printHistogram(std::ostream &os, double bucketMs) {
+        if (samples.empty()) {
+            return;
+        }
+        sortOnce();
+        size_t first = static_cast<size_t>(samples.front() / bucketMs);
+        size_t last = static_cast<size_t>(samples.back() / bucketMs);
+        std::vector<size_t> buckets(last - first + 1, 0);
+        for (double s : samples) {
+            ++buckets[static_cast<size_t>(s / bucketMs) - first];
+        }
+        size_t peak = *std::max_element(buckets.begin(), buckets.end());
+        os << name << " distribution:" << std::endl;
+        for (size_t i = 0; i < buckets.size(); ++i) {
+            os << std::fixed << std::setprecision(1) << std::setw(7) << (first + i) * bucketMs << " ms "
+               << std::setw(6) << buckets[i] << " " << std::string(buckets[i] * 50 / peak, '#') << std::endl;
+        }
+    }
+
+private:
+    void sortOnce() {
+        if (!sorted || sortedCount != samples.size()) {
+            std::sort(samples.begin(), samples.end());
+            sorted = true;
+            sortedCount = samples.size();
+        }
+    }
+
+    std::string name;
+    std::vector<double> samples;
+    bool sorted = false;
+    size_t sortedCount = 0;
+};
+
+// 线性扫频 f0 -> f1，幅度 amplitude (满量程比例)
+inline std::vector<int16_t> makeChirp(double f0, double f1, double seconds, double sampleRate, double amplitude) {
+    size_t n = static_cast<size_t>(seconds * sampleRate);
+    std::vector<int16_t> out(n);
+    double k = (f1 - f0) / seconds;
+    for (size_t i = 0; i < n; ++i) {
+        double t = i / sampleRate;
+        out[i] = static_cast<int16_t>(amplitude * 32767 * std::sin(2 * M_PI * (f0 * t + 0.5 * k * t * t)));
+    }
+    return out;
+}
+
+/**
+ * @brief 在 signal[begin, end) 中用归一化互相关查找 chirp.
+ * @return 最佳匹配的起始下标，相关系数低于 minScore 时返回 -1.
+ */
+inline long findChirp(const std::vector<int16_t> &signal, size_t begin, size_t end,
+                      const std::vector<int16_t> &chirp, double minScore, double *score) {
+    double chirpEnergy = 0;
+    for (int16_t c : chirp) {
+        chirpEnergy += static_cast<double>(c) * c;
+    }
+    end = std::min(end, signal.size());
+    long best = -1;
+    double bestScore = minScore;
+    for (size_t i = begin; i + chirp.size() <= end; ++i) {
+        double dot = 0;
+        double energy = 0;
+        for (size_t j = 0; j < chirp.size(); ++j) {
+            double s = signal[i + j];
+            dot += s * chirp[j];
+            energy += s * s;
+        }
+        if (energy <= 0) {
+            continue;
+        }
+        double r = dot / std::sqrt(energy * chirpEnergy);
+        if (r > bestScore) {
+            bestScore = r;
+            best = static_cast<long>(i);
+        }
+    }
+    if (score) {
+        *score = best >= 0 ? bestScore : 0;
+    }
+    return best;
+}
+
+#endif // RTP_LATENCY_PROBE_H
@@ -9,6 +9,9 @@
 #include <unistd.h>
 #include <arpa/inet.h>
 
+#include "probed_session.h"
+#include "rtp_probes.h"
+
 using namespace jrtplib;
 
 #define SAMPLE_RATE 8000
@@ -17,10 +20,9 @@ using namespace jrtplib;
 #define REMOTE_PORT 9001
 #define REMOTE_IP "127.0.0.1"
 
-RTPSession session;
+ProbedSession session; // packet_sent 探针在包真正发出时触发
 PaStream *inputStream;
 PaStream *outputStream;
-uint32_t timestamp = 0;
 
 void setup_rtp(int port, int remotePort) {
     RTPSessionParams sessparams;
@@ -44,8 +46,8 @@ void audio_send() {
     int16_t buffer[FRAMES_PER_BUFFER];
     while (true) {
         Pa_ReadStream(inputStream, buffer, FRAMES_PER_BUFFER);
-        session.SendPacket(buffer, FRAMES_PER_BUFFER * sizeof(int16_t), 0, false, timestamp);
-        timestamp += FRAMES_PER_BUFFER;
+        // 第五个参数是时间戳增量，每包 FRAMES_PER_BUFFER 个样本
+        session.SendPacket(buffer, FRAMES_PER_BUFFER * sizeof(int16_t), 0, false, FRAMES_PER_BUFFER);
         usleep(20000);
     }
 }
@@ -57,8 +59,10 @@ void audio_receive() {
             do {
                 RTPPacket *packet;
                 while ((packet = session.GetNextPacket()) != nullptr) {
+                    RTP_PROBE_RECEIVED(&session, packet->GetSSRC(), packet->GetSequenceNumber(), packet->GetTimestamp());
                     int frames = packet->GetPayloadLength() / sizeof(int16_t);
                     Pa_WriteStream(outputStream, packet->GetPayloadData(), frames);
+                    RTP_PROBE_PLAYED(&session, packet->GetSSRC(), packet->GetSequenceNumber(), packet->GetTimestamp());
                     session.DeletePacket(packet);
                 }
             } while (session.GotoNextSourceWithData());
@@ -0,0 +1,485 @@
+#ifndef RTP_PIPELINE_H
+#define RTP_PIPELINE_H
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/*
+编译期组合的媒体处理管道。
+
+帧几何 (采样率、帧长、每帧采样数) 是 constexpr 类型参数，每个阶段声明自己的输出几何，
+Pipeline 在编译期推导最终输出大小，并用 static_assert 检查每一级都是整数个采样、帧时长不变；
+各阶段实际推出的采样数是否符合它声明的几何由阶段自己保证，不做检查。阶段按"推"模型逐采样连接：
+stage.push(x, next) 直接调用下一个阶段，编译器把整条链内联成一个循环，
+一帧数据只经过一次缓存，没有中间缓冲。
+
+常用配置由 createPipeline() 返回编译期特化的版本，其它组合退回到 GenericPipeline：
+同样的阶段对象，但每个阶段单独跑一遍整帧，阶段之间用中间缓冲。
+GenericPipeline 只支持 outRate 等于 inRate 或 2 * inRate，其它组合 createPipeline() 返回 nullptr。
+*/
+
+namespace pipeline {
+
+// ----------------------- 帧几何 -----------------------
+
+template <unsigned Rate, unsigned Ms>
+struct Geometry {
+    static_assert(Rate * Ms % 1000 == 0, "frame must hold a whole number of samples");
+    static constexpr unsigned rate = Rate;
+    static constexpr unsigned ms = Ms;
+    static constexpr unsigned samples = Rate * Ms / 1000;
+};
+
+using Narrowband20 = Geometry<8000, 20>; // 160 采样
+using Wideband20 = Geometry<16000, 20>; // 320 采样
+
+// ----------------------- G.711 μ-law -----------------------
+
+constexpr int16_t ulawDecodeSample(uint8_t u) {
+    int v = ~u & 0xff;
+    int t = (((v & 0x0f) << 3) + 0x84) << ((v & 0x70) >> 4);
+    return static_cast<int16_t>((v & 0x80) ? (0x84 - t) : (t - 0x84));
+}
+
+constexpr std::array<int16_t, 256> makeUlawTable() {
+    std::array<int16_t, 256> table {};
+    for (int i = 0; i < 256; ++i) {
+        table[i] = ulawDecodeSample(static_cast<uint8_t>(i));
+    }
+    return table;
+}
+
+constexpr std::array<int16_t, 256> ulawTable = makeUlawTable();
+
+inline uint8_t ulawEncodeSample(int16_t pcm) {
+    int sign = (pcm >> 8) & 0x80;
+    int v = sign ? -static_cast<int>(pcm) : pcm;
+    if (v > 32635) {
+        v = 32635;
+    }
+    v += 0x84;
+    int exponent = 7;
+    for (int mask = 0x4000; (v & mask) == 0 && exponent > 0; mask >>= 1) {
+        --exponent;
+    }
+    int mantissa = (v >> (exponent + 3)) & 0x0f;
+    return static_cast<uint8_t>(~(sign | (exponent << 4) | mantissa));
+}
+
+// ----------------------- 阶段 -----------------------
+// 每个阶段提供:
+//   template <class G> using Out   输出帧几何
+//   push(x, next)                  处理一个采样，向 next 推 0 个或多个采样
+//   end(next)                      一帧结束
+
+struct UlawDecode {
+    using Input = uint8_t;
+    template <class G> using Out = G;
+
+    template <class Next>
+    void push(uint8_t x, Next &next) { next.push(static_cast<float>(ulawTable[x])); }
+    template <class Next>
+    void end(Next &next) { next.end(); }
+};
+
+struct Pcm16Decode {
+    using Input = int16_t;
+    template <class G> using Out = G;
+
+    template <class Next>
+    void push(int16_t x, Next &next) { next.push(static_cast<float>(x)); }
+    template <class Next>
+    void end(Next &next) { next.end(); }
+};
+
+// 2 倍上采样，4 点三次插值 (半带插值器)，群延迟 2 个输入采样
+struct Upsample2 {
+    template <class G> using Out = Geometry<G::rate * 2, G::ms>;
+
+    float x1 = 0, x2 = 0, x3 = 0;
+
+    template <class Next>
+    void push(float x, Next &next) {
+        next.push(x2);
+        next.push((9.0f * (x2 + x1) - (x3 + x)) * 0.0625f);
+        x3 = x2;
+        x2 = x1;
+        x1 = x;
+    }
+    template <class Next>
+    void end(Next &next) { next.end(); }
+};
+
+// 能量 VAD：逐帧计算平均能量，超过阈值判为语音，带拖尾；采样原样透传
+struct EnergyVad {
+    template <class G> using Out = G;
+
+    float threshold = 1e5f; // 平均能量阈值，RMS 约 316，即约 -40 dBFS
+    int hangoverFrames = 10;
+    bool active = false;
+    double energy = 0;
+    unsigned count = 0;
+    int hangover = 0;
+
+    template <class Next>
+    void push(float x, Next &next) {
+        energy += x * x;
+        ++count;
+        next.push(x);
+    }
+    template <class Next>
+    void end(Next &next) {
+        if (count > 0 && energy / count > threshold) {
+            active = true;
+            hangover = hangoverFrames;
+        } else if (hangover > 0) {
+            --hangover;
+        } else {
+            active = false;
+        }
+        energy = 0;
+        count = 0;
+        next.end();
+    }
+};
+
+struct Gain {
+    template <class G> using Out = G;
+
+    float gain = 1.0f;
+
+    template <class Next>
+    void push(float x, Next &next) { next.push(x * gain); }
+    template <class Next>
+    void end(Next &next) { next.end(); }
+};
+
+inline int16_t clampPcm16(float x) {
+    x = x > 32767.0f ? 32767.0f : (x < -32768.0f ? -32768.0f : x);
+    return static_cast<int16_t>(std::lrintf(x));
+}
+
+struct Pcm16Encode {
+    using Output = int16_t;
+    template <class G> using Out = G;
+
+    template <class Next>
+    void push(float x, Next &next) { next.push(clampPcm16(x)); }
+    template <class Next>
+    void end(Next &next) { next.end(); }
+};
+
+struct UlawEncode {
+    using Output = uint8_t;
+    template <class G> using Out = G;
+
+    template <class Next>
+    void push(float x, Next &next) { next.push(ulawEncodeSample(clampPcm16(x))); }
+    template <class Next>
+    void end(Next &next) { next.end(); }
+};
+
+// ----------------------- 编译期组合 -----------------------
+
+template <class T>
+struct ArraySink {
+    T *data = nullptr;
+    size_t count = 0;
+
+    void push(T x) { data[count++] = x; }
+    void end() {}
+};
+
+template <class Sink, class... Stages>
+struct Chain;
+
+template <class Sink>
+struct Chain<Sink> {
+    Sink sink;
+
+    template <class T>
+    void push(T x) { sink.push(x); }
+    void end() { sink.end(); }
+};
+
+template <class Sink, class S, class... Rest>
+struct Chain<Sink, S, Rest...> {
+    S stage;
+    Chain<Sink, Rest...> next;
+
+    template <class T>
+    void push(T x) { stage.push(x, next); }
+    void end() { stage.end(next); }
+
+    template <class Q>
+    Q &get() {
+        if constexpr (std::is_same<Q, S>::value) {
+            return stage;
+        } else {
+            return next.template get<Q>();
+        }
+    }
+};
+
+template <class G, class... Stages>
+struct FoldGeometry {
+    using type = G;
+};
+
+template <class G, class S, class... Rest>
+struct FoldGeometry<G, S, Rest...> {
+    using Next = typename S::template Out<G>;
+    static_assert(Next::ms == G::ms, "a stage must not change the frame duration");
+    using type = typename FoldGeometry<Next, Rest...>::type;
+};
+
+template <class First, class... Rest>
+struct FirstOf {
+    using type = First;
+};
+
+template <class... Stages>
+struct LastOf;
+
+template <class S>
+struct LastOf<S> {
+    using type = S;
+};
+
+template <class S, class... Rest>
+struct LastOf<S, Rest...> {
+    using type = typename LastOf<Rest...>::type;
+};
+
+/**
+ * @brief 编译期组合的管道，第一个阶段是解码器 (定义 Input)，最后一个是编码器 (定义 Output).
+ */
+template <class G, class... Stages>
+class Pipeline {
+    static_assert(sizeof...(Stages) >= 2, "a pipeline needs at least a decoder and an encoder");
+
+public:
+    using InGeometry = G;
+    using OutGeometry = typename FoldGeometry<G, Stages...>::type;
+    using Input = typename FirstOf<Stages...>::type::Input;
+    using Output = typename LastOf<Stages...>::type::Output;
+
+    static constexpr size_t inSamples = InGeometry::samples;
+    static constexpr size_t outSamples = OutGeometry::samples;
+
+    // in: inSamples 个输入，out: outSamples 个输出
+    void process(const Input *in, Output *out) {
+        ArraySink<Output> &sink = tail();
+        sink.data = out;
+        sink.count = 0;
+        for (size_t i = 0; i < inSamples; ++i) {
+            chain.push(in[i]);
+        }
+        chain.end();
+    }
+
+    template <class S>
+    S &get() { return chain.template get<S>(); }
+
+private:
+    ArraySink<Output> &tail() { return tailOf(chain); }
+
+    template <class C>
+    static ArraySink<Output> &tailOf(C &c) {
+        if constexpr (std::is_same<C, Chain<ArraySink<Output>>>::value) {
+            return c.sink;
+        } else {
+            return tailOf(c.next);
+        }
+    }
+
+    Chain<ArraySink<Output>, Stages...> chain;
+};
+
+// ----------------------- 运行时分派 -----------------------
+
+enum Codec {
+    CODEC_ULAW,
+    CODEC_PCM16
+};
+
+struct PipelineSpec {
+    Codec inCodec = CODEC_ULAW;
+    unsigned inRate = 8000;
+    unsigned outRate = 8000; // 等于 inRate 或 2 * inRate
+    unsigned ms = 20;
+    bool vad = true;
+    float vadThreshold = 1e5f;
+    float gain = 1.0f;
+    Codec outCodec = CODEC_PCM16;
+};
+
+class MediaPipeline {
+public:
+    virtual ~MediaPipeline() {}
+    virtual size_t inSamples() const = 0;
+    virtual size_t outSamples() const = 0;
+    // in/out 的元素类型由 PipelineSpec 的编码决定
+    virtual void process(const void *in, void *out) = 0;
+    virtual bool voiceActive() = 0;
+    virtual bool fused() const = 0;
+};
+
+template <class P>
+class FusedPipeline : public MediaPipeline {
+public:
+    explicit FusedPipeline(const PipelineSpec &spec) {
+        if constexpr (hasStage<EnergyVad>()) {
+            p.template get<EnergyVad>().threshold = spec.vadThreshold;
+        }
+        if constexpr (hasStage<Gain>()) {
+            p.template get<Gain>().gain = spec.gain;
+        }
+    }
+
+    size_t inSamples() const override { return P::inSamples; }
+    size_t outSamples() const override { return P::outSamples; }
+    void process(const void *in, void *out) override {
+        p.process(static_cast<const typename P::Input *>(in), static_cast<typename P::Output *>(out));
+    }
+    bool voiceActive() override {
+        if constexpr (hasStage<EnergyVad>()) {
+            return p.template get<EnergyVad>().active;
+        } else {
+            return true;
+        }
+    }
+    bool fused() const override { return true; }
+
+private:
+    template <class S>
+    static constexpr bool hasStage() { return Contains<S, P>::value; }
+
+    template <class S, class Q>
+    struct Contains;
+    template <class S, class Geo, class... Ss>
+    struct Contains<S, Pipeline<Geo, Ss...>> {
+        static constexpr bool value = (std::is_same<S, Ss>::value || ...);
+    };
+
+    P p;
+};
+
+// 逐阶段单独处理整帧，阶段之间通过中间缓冲传递
+class GenericPipeline : public MediaPipeline {
+public:
+    explicit GenericPipeline(const PipelineSpec &spec) :
+        spec(spec),
+        nIn(spec.inRate * spec.ms / 1000),
+        nOut(spec.outRate * spec.ms / 1000),
+        a(nIn > nOut ? nIn : nOut), b(nIn > nOut ? nIn : nOut) {
+        vad.threshold = spec.vadThreshold;
+        gain.gain = spec.gain;
+    }
+
+    // 逐阶段路径能处理的规格：重采样只有 2 倍上采样
+    static bool supports(const PipelineSpec &spec) {
+        return spec.ms > 0 && spec.inRate > 0 && spec.inRate * spec.ms % 1000 == 0 &&
+               (spec.outRate == spec.inRate || spec.outRate == 2 * spec.inRate);
+    }
+
+    size_t inSamples() const override { return nIn; }
+    size_t outSamples() const override { return nOut; }
+
+    void process(const void *in, void *out) override {
+        VecSink sink {a.data(), 0};
+        if (spec.inCodec == CODEC_ULAW) {
+            UlawDecode dec;
+            runStage(dec, static_cast<const uint8_t *>(in), nIn, sink);
+        } else {
+            Pcm16Decode dec;
+            runStage(dec, static_cast<const int16_t *>(in), nIn, sink);
+        }
+        size_t n = nIn;
+        if (spec.outRate == 2 * spec.inRate) {
+            n = pass(upsample, n);
+        }
+        if (spec.vad) {
+            n = pass(vad, n);
+        }
+        if (spec.gain != 1.0f) {
+            n = pass(gain, n);
+        }
+        if (spec.outCodec == CODEC_ULAW) {
+            ArraySink<uint8_t> outSink;
+            outSink.data = static_cast<uint8_t *>(out);
+            UlawEncode enc;
+            runStage(enc, a.data(), n, outSink);
+        } else {
+            ArraySink<int16_t> outSink;
+            outSink.data = static_cast<int16_t *>(out);
+            Pcm16Encode enc;
+            runStage(enc, a.data(), n, outSink);
+        }
+    }
+
+    bool voiceActive() override { return spec.vad ? vad.active : true; }
+    bool fused() const override { return false; }
+
+private:
+    struct VecSink {
+        float *data;
+        size_t count;
+        void push(float x) { data[count++] = x; }
+        void end() {}
+    };
+
+    template <class S, class T, class Sink>
+    static void runStage(S &stage, const T *in, size_t n, Sink &sink) {
+        for (size_t i = 0; i < n; ++i) {
+            stage.push(in[i], sink);
+        }
+        stage.end(sink);
+    }
+
+    // a -> b，然后交换，结果总在 a 中
+    template <class S>
+    size_t pass(S &stage, size_t n) {
+        VecSink sink {b.data(), 0};
+        runStage(stage, a.data(), n, sink);
+        a.swap(b);
+        return sink.count;
+    }
+
+    PipelineSpec spec;
+    size_t nIn;
+    size_t nOut;
+    std::vector<float> a;
+    std::vector<float> b;
+    Upsample2 upsample;
+    EnergyVad vad;
+    Gain gain;
+};
+
+// 常用配置的编译期特化
+using AsrIngest = Pipeline<Narrowband20, UlawDecode, Upsample2, EnergyVad, Gain, Pcm16Encode>;
+using NarrowbandIngest = Pipeline<Narrowband20, UlawDecode, EnergyVad, Gain, Pcm16Encode>;
+
+inline std::unique_ptr<MediaPipeline> createPipeline(const PipelineSpec &spec) {
+    bool common = spec.inCodec == CODEC_ULAW && spec.outCodec == CODEC_PCM16 &&
+                  spec.inRate == Narrowband20::rate && spec.ms == Narrowband20::ms && spec.vad;
+    if (common && spec.outRate == AsrIngest::OutGeometry::rate) {
+        return std::unique_ptr<MediaPipeline>(new FusedPipeline<AsrIngest>(spec));
+    }
+    if (common && spec.outRate == NarrowbandIngest::OutGeometry::rate) {
+        return std::unique_ptr<MediaPipeline>(new FusedPipeline<NarrowbandIngest>(spec));
+    }
+    if (!GenericPipeline::supports(spec)) {
+        return nullptr;
+    }
+    return std::unique_ptr<MediaPipeline>(new GenericPipeline(spec));
+}
+
+} // namespace pipeline
+
+#endif // RTP_PIPELINE_H
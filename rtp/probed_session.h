@@ -0,0 +1,61 @@
+#ifndef RTP_PROBED_SESSION_H
+#define RTP_PROBED_SESSION_H
+
+#include <jrtplib3/rtpsession.h>
+
+#include <cstdint>
+#include <cstring>
+
+#include "rtp_packet.h"
+#include "rtp_probes.h"
+
+/*
+在 JRTPLIB 真正把 RTP 包交给传输层时触发 packet_sent 探针。
+
+包照常用 SendPacket() 发：JRTPLIB 自己维护序列号/时间戳 (随机起点)，发过包的会话才会
+发 SR，BYEDestroy() 才会发 BYE。SendRawData() 两样都不做，只应该用于 FEC 这类旁路包。
+借助 SetChangeOutgoingData() 的钩子 (SRTP 用的同一个) 看到组好的包，探针报告的
+序列号和时间戳就是线路上的值；数据原样发出，不做修改。
+
+keepLast 为 true 时保留最后发出的 RTP 包，供 XOR FEC 这类需要完整媒体包的编码器使用。
+*/
+
+class ProbedSession : public jrtplib::RTPSession {
+public:
+    explicit ProbedSession(bool keepLast = false) : keepLast(keepLast), lastLen(0) {
+        SetChangeOutgoingData(true);
+    }
+
+    // 最后一次 SendPacket() 组出的 RTP 包，只在 keepLast 时有效
+    const uint8_t *lastPacket() const { return last; }
+    size_t lastPacketLength() const { return lastLen; }
+
+protected:
+    int OnChangeRTPOrRTCPData(const void *origdata, size_t origlen, bool isrtp, void **senddata,
+                              size_t *sendlen) override {
+        *senddata = const_cast<void *>(origdata);
+        *sendlen = origlen;
+        if (isrtp) {
+            const uint8_t *p = static_cast<const uint8_t *>(origdata);
+            RtpHeader h;
+            if (rtpParseHeader(p, origlen, h) != 0) {
+                RTP_PROBE_SENT(this, h.ssrc, h.seq, h.timestamp);
+                if (keepLast && origlen <= sizeof(last)) {
+                    memcpy(last, p, origlen);
+                    lastLen = origlen;
+                }
+            }
+        }
+        return 0;
+    }
+
+    // 数据没有复制，发完不需要释放
+    void OnSentRTPOrRTCPData(void *, size_t, bool) override {}
+
+private:
+    bool keepLast;
+    uint8_t last[RTP_MAX_PACKET];
+    size_t lastLen;
+};
+
+#endif // RTP_PROBED_SESSION_H
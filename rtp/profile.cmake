@@ -0,0 +1,13 @@
+# 跟踪/性能分析的编译设置，根目录和 rtp/ 的 CMakeLists.txt 共用 (见 trace/)
+
+# rtp_probes.h 的 USDT 探针，系统没有 <sys/sdt.h> 时自动关闭
+option(RTP_USDT "Enable USDT probes on the packet path" ON)
+if(RTP_USDT)
+    add_definitions(-DRTP_USDT)
+endif()
+
+# 性能分析构建: cmake -DCMAKE_BUILD_TYPE=Profile
+# 优化 + 调试信息 + 保留帧指针，perf/bpftrace 按帧指针回溯用户态栈
+# 不加 FORCE，命令行 -DCMAKE_CXX_FLAGS_PROFILE=... 可以覆盖
+set(CMAKE_CXX_FLAGS_PROFILE "-O2 -g -fno-omit-frame-pointer -mno-omit-leaf-frame-pointer"
+    CACHE STRING "Flags used by the C++ compiler during Profile builds.")
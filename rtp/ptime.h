@@ -0,0 +1,108 @@
+#ifndef RTP_PTIME_H
+#define RTP_PTIME_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/*
+打包时长 (ptime，SDP a=ptime) 与采集分块解耦。
+
+发送端：采集按设备自己的块大小 (例如 10ms) 送入 PtimeAggregator，攒够一个 ptime 出一个包，
+ptime 可以在会话中途修改，从下一个包开始生效。时间戳按实际样本数推进，与 ptime 无关。
+接收端：FecPlayout 按 PTIME_FRAME_MS 的播放帧建索引，更长的包在入缓冲时拆开，
+所以发送端用任意 ptime 接收端都不需要事先知道。
+
+ptime 取 10~60ms、10ms 的整数倍：
+- 10ms 延迟最低，但 L16 @ 8kHz 每秒 100 个包、头部开销 (IP+UDP+RTP 40 字节) 占 20%；
+- 40/60ms 包速率减半/减到 1/3，适合能容忍延迟的中继线路。
+*/
+
+#define PTIME_MIN_MS 10
+#define PTIME_MAX_MS 60
+#define PTIME_DEFAULT_MS 20
+#define PTIME_FRAME_MS 10 // 接收端播放帧长，也是 ptime 的粒度
+
+inline bool ptimeValid(unsigned ms) {
+    return ms >= PTIME_MIN_MS && ms <= PTIME_MAX_MS && ms % PTIME_FRAME_MS == 0;
+}
+
+// ms 时长对应的 RTP 时间戳单位数
+inline uint32_t ptimeSamples(unsigned ms, uint32_t clockRate) {
+    return static_cast<uint32_t>(static_cast<uint64_t>(ms) * clockRate / 1000);
+}
+
+class PtimeAggregator {
+public:
+    /**
+     * @param ptimeMs 打包时长，不合法时用 PTIME_DEFAULT_MS
+     * @param clockRate RTP 时钟频率
+     * @param bytesPerSample 负载里每个时间戳单位占的字节数 (L16 为 2，G.711 为 1)
+     */
+    PtimeAggregator(unsigned ptimeMs = PTIME_DEFAULT_MS, uint32_t clockRate = 8000,
+                    unsigned bytesPerSample = 2, uint32_t timestamp = 0) :
+        ptime(ptimeValid(ptimeMs) ? ptimeMs : PTIME_DEFAULT_MS), clockRate(clockRate),
+        bytesPerSample(bytesPerSample), head(0), tail(0), nextTs(timestamp),
+        buffer(ptimeSamples(PTIME_MAX_MS, clockRate) * bytesPerSample * 2) {}
+
+    // 修改 ptime，下一个包生效
+    bool setPtime(unsigned ms) {
+        if (!ptimeValid(ms)) {
+            return false;
+        }
+        ptime = ms;
+        return true;
+    }
+
+    unsigned getPtime() const { return ptime; }
+
+    // 当前 ptime 下一个包的负载字节数
+    size_t packetBytes() const { return ptimeSamples(ptime, clockRate) * bytesPerSample; }
+
+    // 送入采集到的样本，长度任意
+    void push(const uint8_t *data, size_t len) {
+        if (tail + len > buffer.size()) {
+            // 已取出的部分前移；采集块比缓冲大时扩容
+            memmove(buffer.data(), buffer.data() + head, tail - head);
+            tail -= head;
+            head = 0;
+            if (tail + len > buffer.size()) {
+                buffer.resize(tail + len);
+            }
+        }
+        memcpy(buffer.data() + tail, data, len);
+        tail += len;
+    }
+
+    /**
+     * @brief 取出一个包的负载.
+     * @return false 表示还不够一个 ptime；payload 在下一次 push() 之前有效.
+     */
+    bool pop(const uint8_t **payload, size_t *len, uint32_t *timestamp) {
+        size_t n = packetBytes();
+        if (tail - head < n) {
+            return false;
+        }
+        *payload = buffer.data() + head;
+        *len = n;
+        *timestamp = nextTs;
+        head += n;
+        nextTs += static_cast<uint32_t>(n / bytesPerSample);
+        return true;
+    }
+
+    // 还没打包的时长
+    size_t pendingSamples() const { return (tail - head) / bytesPerSample; }
+
+private:
+    unsigned ptime;
+    uint32_t clockRate;
+    unsigned bytesPerSample;
+    size_t head;
+    size_t tail;
+    uint32_t nextTs;
+    std::vector<uint8_t> buffer;
+};
+
+#endif // RTP_PTIME_H
@@ -4,16 +4,39 @@
 #include <jrtplib3/rtpipv4address.h>
 #include <jrtplib3/rtpudpv4transmitter.h>
 #include <jrtplib3/rtpsessionparams.h>
+#include <jrtplib3/rtpsourcedata.h>
 #include <portaudio.h>
 #include <unistd.h>
+#include <arpa/inet.h>
+#include <random>
+#include <vector>
+
+#include "fec.h"
+#include "ptime.h"
+#include "rtp_probes.h"
+#include "tone_detect.h"
 
 using namespace jrtplib;
 
+/*
+接收、FEC 恢复、播放。
+RTCP 接收报告 (RR) 要发回发送端，发送端据此调整 FEC 冗余度：
+命令行给出发送端 IP 时发到 <IP>:SENDER_PORT，否则从收到的第一个 RTP 包的源地址学习。
+播放的音频里检测到的 DTMF 和应答音/传真音以 RFC 4733 telephone-event (PT EVENT_PT)
+发往同一目标，使用本会话的 SSRC，序列号/时间戳自成一个空间。
+用法: receiver [发送端 IP]
+*/
+
 #define SAMPLE_RATE 8000
 #define FRAMES_PER_BUFFER 160
+#define PLAYOUT_FRAME (SAMPLE_RATE * PTIME_FRAME_MS / 1000)  // 播放帧 10ms，任意 ptime 的包都拆成这个长度
 #define PORT_BASE 9000  // 必须与 Sender 的 DEST_PORT 一致
+#define SENDER_PORT 9000  // Sender 的 PORT_BASE，命令行给出发送端 IP 时 RR 发到这里
+#define RED_PT 97
+#define FEC_PT 98
+#define EVENT_PT 101
 
-int main() {
+int main(int argc, char *argv[]) {
     Pa_Initialize();
 
     PaStream *outputStream;
@@ -39,20 +62,87 @@ int main() {
         return 1;
     }
 
+    // 不发 RTP，只让 JRTPLIB 把接收报告 (RR) 发回发送端
+    bool haveDestination = false;
+    if (argc > 1) {
+        sess.AddDestination(RTPIPv4Address(ntohl(inet_addr(argv[1])), SENDER_PORT));
+        haveDestination = true;
+    }
+
+    // 在播放前做 RED/XOR 恢复，普通媒体包直接透传；发送端的 ptime 不需要事先知道
+    FecPlayout playout(RED_PT, FEC_PT, PLAYOUT_FRAME, sizeof(int16_t));
+    std::vector<uint8_t> frame;
+    std::vector<int16_t> silence(PLAYOUT_FRAME, 0);
+
+    // 带内 DTMF 和传真/调制解调器应答音检测
+    ToneDetectorBank tones(1, SAMPLE_RATE);
+    tones.addTone(2100, 400, RFC4733_EVENT_ANS);
+    tones.addTone(1100, 400, RFC4733_EVENT_CNG);
+    tones.open(0);
+    std::vector<ToneEvent> toneEvents;
+    // 接收端自己不发媒体，事件包不经过 JRTPLIB 的包构造，起始序列号和时间戳随机
+    std::random_device rd;
+    TelephoneEventStream eventStream(EVENT_PT, sess.GetLocalSSRC(), static_cast<uint16_t>(rd()), rd());
+    std::vector<TelephoneEventRtp> eventPackets;
+
     std::cout << "Receiving audio on port " << PORT_BASE << "..." << std::endl;
 
     while (true) {
         sess.Poll();
         if (sess.GotoFirstSourceWithData()) {
             do {
+                if (!haveDestination) {
+                    // 发送端从自己的 RTP 端口发包，RTCP 端口为它 + 1，与 AddDestination 的约定一致
+                    const RTPIPv4Address *from =
+                        static_cast<const RTPIPv4Address *>(sess.GetCurrentSourceInfo()->GetRTPDataAddress());
+                    if (from) {
+                        sess.AddDestination(RTPIPv4Address(from->GetIP(), from->GetPort()));
+                        haveDestination = true;
+                        std::cout << "Sending RTCP reports to sender port " << from->GetPort() << std::endl;
+                    }
+                }
                 RTPPacket *packet;
                 while ((packet = sess.GetNextPacket()) != nullptr) {
-                    int frameCount = packet->GetPayloadLength() / sizeof(int16_t);
-                    Pa_WriteStream(outputStream, packet->GetPayloadData(), frameCount);
+                    uint32_t ssrc = packet->GetSSRC();
+                    RTP_PROBE_RECEIVED(&sess, ssrc, packet->GetSequenceNumber(), packet->GetTimestamp());
+                    playout.input(packet->GetPacketData(), packet->GetPacketLength());
+                    RTP_PROBE_QUEUED(&sess, ssrc, packet->GetSequenceNumber(), packet->GetTimestamp());
                     sess.DeletePacket(packet);
                 }
             } while (sess.GotoNextSourceWithData());
         }
+
+        bool concealed;
+        while (playout.pop(frame, &concealed)) {
+            // 最后收到的包可能是 FEC 流的，播放阶段用媒体流的 SSRC；
+            // seq/ts 取该帧所在的原始媒体包，和 packet_received 的键一致
+            uint32_t ssrc = playout.lastSsrc();
+            uint16_t seq = playout.lastPacketSeq();
+            uint32_t ts = playout.lastPacketTimestamp();
+            RTP_PROBE_DEQUEUED(&sess, ssrc, seq, ts);
+            const int16_t *pcm = concealed ? silence.data() : reinterpret_cast<const int16_t *>(frame.data());
+            size_t samples = concealed ? PLAYOUT_FRAME : frame.size() / sizeof(int16_t);
+            RTP_PROBE_DECODED(&sess, ssrc, seq, ts);
+            Pa_WriteStream(outputStream, pcm, samples);
+            RTP_PROBE_PLAYED(&sess, ssrc, seq, ts);
+            tones.process(&pcm, samples, toneEvents);
+        }
+        for (const ToneEvent &e : toneEvents) {
+            if (e.event < 16) {
+                std::cout << "DTMF " << dtmfEventDigit(e.event) << (e.end ? " up" : " down") << std::endl;
+            } else {
+                std::cout << "Tone event " << static_cast<int>(e.event) << (e.end ? " ended" : " detected") << std::endl;
+            }
+            eventStream.onEvent(e, eventPackets);
+        }
+        toneEvents.clear();
+        eventStream.advance(tones.now(), eventPackets);
+        if (haveDestination) {
+            for (const TelephoneEventRtp &p : eventPackets) {
+                sess.SendRawData(p.bytes, sizeof(p.bytes), true);
+            }
+        }
+        eventPackets.clear();
         usleep(10000);
     }
 
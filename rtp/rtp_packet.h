@@ -0,0 +1,101 @@
+#ifndef RTP_RTP_PACKET_H
+#define RTP_RTP_PACKET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/*
+RTP 固定头 (RFC 3550 5.1) 的序列化/解析。
+JRTPLIB 的 SendPacket 会自己分配序列号和时间戳，需要完全控制包头的场景
+(FEC、转发改写等) 用这里组包，再通过 RTPSession::SendRawData 发出。
+*/
+
+#define RTP_HEADER_SIZE 12
+#define RTP_MAX_PACKET 1500
+
+struct RtpHeader {
+    bool padding;
+    bool extension;
+    uint8_t csrcCount;
+    bool marker;
+    uint8_t payloadType;
+    uint16_t seq;
+    uint32_t timestamp;
+    uint32_t ssrc;
+
+    RtpHeader() :
+        padding(false), extension(false), csrcCount(0), marker(false),
+        payloadType(0), seq(0), timestamp(0), ssrc(0) {}
+};
+
+inline void rtpPut16(uint8_t *p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v >> 8);
+    p[1] = static_cast<uint8_t>(v);
+}
+
+inline void rtpPut32(uint8_t *p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v >> 24);
+    p[1] = static_cast<uint8_t>(v >> 16);
+    p[2] = static_cast<uint8_t>(v >> 8);
+    p[3] = static_cast<uint8_t>(v);
+}
+
+inline uint16_t rtpGet16(const uint8_t *p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+inline uint32_t rtpGet32(const uint8_t *p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+// 写入 12 字节固定头 (不含 CSRC 列表)
+inline void rtpWriteHeader(uint8_t *p, const RtpHeader &h) {
+    p[0] = static_cast<uint8_t>(0x80 | (h.padding ? 0x20 : 0) | (h.extension ? 0x10 : 0) | (h.csrcCount & 0x0f));
+    p[1] = static_cast<uint8_t>((h.marker ? 0x80 : 0) | (h.payloadType & 0x7f));
+    rtpPut16(p + 2, h.seq);
+    rtpPut32(p + 4, h.timestamp);
+    rtpPut32(p + 8, h.ssrc);
+}
+
+// 解析固定头，返回负载起始偏移 (跳过 CSRC 和扩展头)，非法包返回 0
+inline size_t rtpParseHeader(const uint8_t *p, size_t len, RtpHeader &h) {
+    if (len < RTP_HEADER_SIZE || (p[0] >> 6) != 2) {
+        return 0;
+    }
+    h.padding = (p[0] & 0x20) != 0;
+    h.extension = (p[0] & 0x10) != 0;
+    h.csrcCount = p[0] & 0x0f;
+    h.marker = (p[1] & 0x80) != 0;
+    h.payloadType = p[1] & 0x7f;
+    h.seq = rtpGet16(p + 2);
+    h.timestamp = rtpGet32(p + 4);
+    h.ssrc = rtpGet32(p + 8);
+
+    size_t off = RTP_HEADER_SIZE + h.csrcCount * 4;
+    if (h.extension) {
+        if (len < off + 4) {
+            return 0;
+        }
+        off += 4 + rtpGet16(p + off + 2) * 4;
+    }
+    return off <= len ? off : 0;
+}
+
+// 组一个无 CSRC、无扩展的 RTP 包，返回总长度
+inline size_t rtpBuildPacket(uint8_t *out, size_t cap, const RtpHeader &h,
+                             const uint8_t *payload, size_t len) {
+    if (cap < RTP_HEADER_SIZE + len) {
+        return 0;
+    }
+    RtpHeader plain = h;
+    plain.csrcCount = 0;
+    plain.extension = false;
+    plain.padding = false;
+    rtpWriteHeader(out, plain);
+    memcpy(out + RTP_HEADER_SIZE, payload, len);
+    return RTP_HEADER_SIZE + len;
+}
+
+#endif // RTP_RTP_PACKET_H
@@ -0,0 +1,49 @@
+#ifndef RTP_PROBES_H
+#define RTP_PROBES_H
+
+#include <cstdint>
+
+/*
+包处理路径上的 USDT 静态探针，provider 为 rtp：
+
+  packet_received  从会话取出一个 RTP 包
+  packet_queued    放入抖动/FEC 播放缓冲
+  packet_dequeued  从播放缓冲取出一帧
+  frame_decoded    得到可播放的 PCM (解码、恢复或丢包补偿之后)
+  frame_played     写入声卡
+  packet_sent      发出一个 RTP 包
+
+参数都是 (session, ssrc, seq, timestamp)：session 为进程内的会话标识 (RTPSession 地址)。
+各阶段的 seq/timestamp 都是媒体包的 RTP 头 (packet_sent 为线路上的值，见 probed_session.h)；
+播放缓冲之后的阶段报告该帧最初所在的媒体包 (FecPlayout::lastPacketTimestamp())，
+一个包拆成的几个播放帧键相同、按顺序出现，RED 恢复的帧 seq 为 0。
+跨阶段的连接键是 (session, ssrc, timestamp)，不要用 seq。
+
+用 -DRTP_USDT 编译且系统有 <sys/sdt.h> (systemtap-sdt-dev) 时生效。
+没有跟踪器挂载时每个探针只是一条 nop，参数已在寄存器里，不产生额外开销；
+否则宏展开为空。跟踪脚本在 trace/ 下。
+*/
+
+#if defined(RTP_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define RTP_PROBES_ENABLED 1
+#endif
+#endif
+
+#ifdef RTP_PROBES_ENABLED
+#define RTP_PROBE(name, session, ssrc, seq, ts)                                            \
+    DTRACE_PROBE4(rtp, name, (uint64_t)(uintptr_t)(session), (uint32_t)(ssrc), (uint32_t)(seq), \
+                  (uint32_t)(ts))
+#else
+#define RTP_PROBE(name, session, ssrc, seq, ts) do { } while (0)
+#endif
+
+#define RTP_PROBE_RECEIVED(session, ssrc, seq, ts) RTP_PROBE(packet_received, session, ssrc, seq, ts)
+#define RTP_PROBE_QUEUED(session, ssrc, seq, ts) RTP_PROBE(packet_queued, session, ssrc, seq, ts)
+#define RTP_PROBE_DEQUEUED(session, ssrc, seq, ts) RTP_PROBE(packet_dequeued, session, ssrc, seq, ts)
+#define RTP_PROBE_DECODED(session, ssrc, seq, ts) RTP_PROBE(frame_decoded, session, ssrc, seq, ts)
+#define RTP_PROBE_PLAYED(session, ssrc, seq, ts) RTP_PROBE(frame_played, session, ssrc, seq, ts)
+#define RTP_PROBE_SENT(session, ssrc, seq, ts) RTP_PROBE(packet_sent, session, ssrc, seq, ts)
+
+#endif // RTP_PROBES_H
@@ -1,22 +1,43 @@
 #include <iostream>
+#include <cstdlib>
 #include <jrtplib3/rtpsession.h>
 #include <jrtplib3/rtppacket.h>
 #include <jrtplib3/rtpipv4address.h>
 #include <jrtplib3/rtpudpv4transmitter.h>
 #include <jrtplib3/rtpsessionparams.h>
+#include <jrtplib3/rtpsourcedata.h>
 #include <portaudio.h>
 #include <unistd.h>
 #include <arpa/inet.h>
 
+#include "fec.h"
+#include "ptime.h"
+#include "probed_session.h"
+
 using namespace jrtplib;
 
 #define SAMPLE_RATE 8000
-#define FRAMES_PER_BUFFER 160
+#define FRAMES_PER_BUFFER 80  // 采集块 10ms，与 ptime 无关
 #define PORT_BASE 9000
 #define DEST_IP "192.168.240.192"
 #define DEST_PORT 9000  // 要与 receiver 的 PORT_BASE 一致
 
-int main() {
+#define USE_FEC 1       // RED + XOR FEC，冗余度按 RTCP 丢包率调整
+#define MEDIA_PT 0
+#define RED_PT 97
+#define FEC_PT 98
+#define FEC_ADAPT_INTERVAL_MS 1000  // 每 1s 检查一次 RR
+#define FEC_INITIAL_LOSS 0.05       // 收到第一个 RR 之前按 5% 丢包保护
+
+// 用法: sender [ptime_ms]，ptime 为 10~60ms，默认 20ms
+int main(int argc, char *argv[]) {
+    unsigned ptime = argc > 1 ? static_cast<unsigned>(atoi(argv[1])) : PTIME_DEFAULT_MS;
+    if (!ptimeValid(ptime)) {
+        std::cerr << "ptime must be " << PTIME_MIN_MS << "-" << PTIME_MAX_MS << " ms in steps of "
+                  << PTIME_FRAME_MS << std::endl;
+        return 1;
+    }
+
     Pa_Initialize();
 
     PaStream *inputStream;
@@ -29,8 +50,8 @@ int main() {
 
     Pa_StartStream(inputStream);
 
-    // RTP 初始化
-    RTPSession sess;
+    // RTP 初始化，媒体包走 SendPacket() (SR/BYE 照常)，只有 XOR 校验包是 SendRawData()
+    ProbedSession sess(USE_FEC);
     RTPSessionParams sessparams;
     sessparams.SetOwnTimestampUnit(1.0 / SAMPLE_RATE);
     sessparams.SetAcceptOwnPackets(true);
@@ -47,10 +68,33 @@ int main() {
     ip = ntohl(ip); // JRTPLib 使用主机字节序
     sess.AddDestination(RTPIPv4Address(ip, DEST_PORT));
 
+    // 采集块攒成 ptime 再发
     int16_t buffer[FRAMES_PER_BUFFER];
-    uint32_t timestamp = 0;
+    PtimeAggregator aggregator(ptime, SAMPLE_RATE, sizeof(int16_t));
+    const uint8_t *frame;
+    size_t frameLen;
+    uint32_t timestamp;
 
-    std::cout << "Sending audio to " << DEST_IP << ":" << DEST_PORT << "..." << std::endl;
+#if USE_FEC
+    // FEC 包使用独立的 SSRC/序列号空间
+    RedEncoder red(MEDIA_PT);
+    XorFecEncoder xorFec(FEC_PT, fecSsrcFor(sess.GetLocalSSRC()));
+    FecLevel level = fecLevelForLoss(FEC_INITIAL_LOSS);
+    red.setDistance(level.redDistance);
+    xorFec.setGroupSize(level.xorGroup);
+    uint8_t payload[RTP_MAX_PACKET - RTP_HEADER_SIZE];
+    uint8_t parity[RTP_MAX_PACKET];
+    unsigned sentMs = 0;
+    // ptime 较长时一个包装不下 RED_MAX_DISTANCE 个冗余帧，冗余度按装得下的封顶
+    int redCap = redMaxDistance(aggregator.packetBytes(), sizeof(payload));
+    if (redCap < RED_MAX_DISTANCE) {
+        std::cout << "ptime " << ptime << " ms: at most " << redCap << " redundant frame(s) fit in a packet"
+                  << std::endl;
+    }
+#endif
+
+    std::cout << "Sending audio to " << DEST_IP << ":" << DEST_PORT << ", ptime " << ptime << " ms..."
+              << std::endl;
 
     while (true) {
         err = Pa_ReadStream(inputStream, buffer, FRAMES_PER_BUFFER);
@@ -58,11 +102,67 @@ int main() {
             std::cerr << "Error reading from input: " << Pa_GetErrorText(err) << std::endl;
             break;
         }
+        aggregator.push(reinterpret_cast<const uint8_t *>(buffer), sizeof(buffer));
+
+        while (aggregator.pop(&frame, &frameLen, &timestamp)) {
+#if USE_FEC
+            size_t payloadLen = red.encode(frame, frameLen, timestamp, payload, sizeof(payload));
+
+            // 放不下的冗余帧 encode() 已经丢掉，一个都带不上时只发主帧
+            // RED 里的时间戳偏移是相对值，与 JRTPLIB 的随机时间戳起点无关
+            uint32_t samples = static_cast<uint32_t>(frameLen / sizeof(int16_t));
+            if (red.lastDistance() > 0) {
+                sess.SendPacket(payload, payloadLen, RED_PT, false, samples);
+            } else {
+                sess.SendPacket(frame, frameLen, MEDIA_PT, false, samples);
+            }
 
-        sess.SendPacket(buffer, FRAMES_PER_BUFFER * sizeof(int16_t), 0, false, timestamp);
-        timestamp += FRAMES_PER_BUFFER;
+            // 校验覆盖线路上的媒体包，取 JRTPLIB 刚组好的那个
+            size_t pn = xorFec.addMedia(sess.lastPacket(), sess.lastPacketLength(), parity, sizeof(parity));
+            if (pn > 0) {
+                sess.SendRawData(parity, pn, true);
+            }
 
-        usleep(20000);  // 控制帧率，适配 8000Hz 采样率
+            // 处理 RTCP，根据对端 RR 中的丢包率调整冗余度
+            sess.Poll();
+            sentMs += aggregator.getPtime();
+            if (sentMs >= FEC_ADAPT_INTERVAL_MS) {
+                sentMs = 0;
+                double fractionLost = 0.0;
+                bool haveRR = false;
+                sess.BeginDataAccess();
+                if (sess.GotoFirstSource()) {
+                    do {
+                        RTPSourceData *src = sess.GetCurrentSourceInfo();
+                        if (src->RR_HasInfo(false)) {
+                            haveRR = true;
+                            if (src->RR_GetFractionLost(false) > fractionLost) {
+                                fractionLost = src->RR_GetFractionLost(false);
+                            }
+                        }
+                    } while (sess.GotoNextSource());
+                }
+                sess.EndDataAccess();
+
+                // 没有 RR (接收端没把 RTCP 发回来) 时保持当前冗余度
+                FecLevel next = haveRR ? fecLevelForLoss(fractionLost) : level;
+                if (next.redDistance != level.redDistance || next.xorGroup != level.xorGroup) {
+                    std::cout << "loss " << fractionLost * 100 << "%: RED distance "
+                              << (next.redDistance < redCap ? next.redDistance : redCap);
+                    if (next.redDistance > redCap) {
+                        std::cout << " (wanted " << next.redDistance << ")";
+                    }
+                    std::cout << ", XOR group " << next.xorGroup << std::endl;
+                    level = next;
+                    red.setDistance(level.redDistance);
+                    xorFec.setGroupSize(level.xorGroup);
+                }
+            }
+#else
+            sess.SendPacket(frame, frameLen, MEDIA_PT, false, static_cast<uint32_t>(frameLen / sizeof(int16_t)));
+#endif
+        }
+        // Pa_ReadStream 阻塞到采满一块，发送节奏由采集决定
     }
 
     Pa_StopStream(inputStream);
@@ -0,0 +1,254 @@
+#ifndef RTP_SESSION_POOL_H
+#define RTP_SESSION_POOL_H
+
+#include <jrtplib3/rtpsession.h>
+#include <jrtplib3/rtpsessionparams.h>
+#include <jrtplib3/rtpudpv4transmitter.h>
+#include <jrtplib3/rtpipv4address.h>
+#include <jrtplib3/rtperrors.h>
+
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "probed_session.h"
+
+/*
+预绑定端口对的 RTPSession 池。
+
+Create() 要绑定 RTP/RTCP 两个 socket，BYEDestroy() 最长会阻塞到超时，
+两者都不应该出现在呼叫建立/拆除的路径上：
+- acquire() 只从空闲栈弹出一个已经 Create 好的会话并添加目标地址；
+- release() 把会话交给后台线程，由后台线程发送 BYE、销毁并在同一对 socket 上重新 Create，
+  然后放回空闲栈。每次重建都会得到新的 SSRC。
+socket 由池自己绑定后交给 JRTPLIB (SetUseExistingSockets)，描述符在池的生命周期内不变，
+调用方可以在上面 poll/epoll；会话不使用 JRTPLIB 的轮询线程，由调用方 Poll()。
+
+回收线程逐个等 BYE，持续的呼叫建立速率上限约为 reclaimThreads / byeWait
+(默认 200ms 时每个线程约 5 个呼叫/秒)，超过后空闲栈会被取空，acquire() 返回 nullptr。
+会话归池所有：stop() 和析构之前调用方必须 release() 所有取出的会话。
+*/
+
+struct PooledSession {
+    ProbedSession session;
+    uint16_t portbase;
+    int rtpSocket = -1;
+    int rtcpSocket = -1;
+};
+
+class SessionPool {
+public:
+    /**
+     * @param portbase 第一个会话的 RTP 端口，第 i 个会话使用 portbase + 2 * i
+     * @param size 会话数
+     * @param timestampUnit 时间戳单位，例如 1.0 / 8000
+     * @param reclaimThreads 后台回收线程数，BYE 等待是串行的，
+     *        每秒的呼叫数超过 reclaimThreads / byeWait 时要多开几个
+     */
+    SessionPool(uint16_t portbase, size_t size, double timestampUnit, size_t reclaimThreads = 1) :
+        portbase(portbase), size(size), timestampUnit(timestampUnit),
+        reclaimThreads(reclaimThreads), byeWait(0, 200000), lost(0), running(false) {}
+
+    ~SessionPool() {
+        stop();
+        for (auto &entry : all) {
+            closeSockets(*entry);
+        }
+    }
+
+    // BYE 的最长等待时间，只影响后台线程
+    void setByeWait(const jrtplib::RTPTime &wait) { byeWait = wait; }
+
+    /**
+     * @brief 创建并绑定全部会话，启动回收线程.
+     * @return 第一个失败的 JRTPLIB 错误码，全部成功返回 0.
+     */
+    int init() {
+        for (size_t i = 0; i < size; ++i) {
+            std::unique_ptr<PooledSession> entry(new PooledSession);
+            entry->portbase = static_cast<uint16_t>(portbase + 2 * i);
+            entry->rtpSocket = bindUdp(entry->portbase);
+            entry->rtcpSocket = bindUdp(static_cast<uint16_t>(entry->portbase + 1));
+            if (entry->rtpSocket < 0 || entry->rtcpSocket < 0) {
+                closeSockets(*entry);
+                return entry->rtpSocket < 0 ? ERR_RTP_UDPV4TRANS_CANTBINDRTPSOCKET
+                                            : ERR_RTP_UDPV4TRANS_CANTBINDRTCPSOCKET;
+            }
+            int status = create(*entry);
+            if (status < 0) {
+                closeSockets(*entry);
+                return status;
+            }
+            idle.push_back(entry.get());
+            all.push_back(std::move(entry));
+        }
+        running = true;
+        for (size_t i = 0; i < reclaimThreads; ++i) {
+            workers.push_back(std::thread(&SessionPool::reclaimLoop, this));
+        }
+        return 0;
+    }
+
+    /**
+     * @brief 取出一个就绪的会话并设置目标地址 (主机字节序).
+     * @return 池已耗尽时返回 nullptr.
+     */
+    PooledSession *acquire(uint32_t destIp, uint16_t destPort) {
+        PooledSession *entry;
+        {
+            std::lock_guard<std::mutex> lock(idleMutex);
+            if (idle.empty()) {
+                return nullptr;
+            }
+            entry = idle.back();
+            idle.pop_back();
+        }
+        if (entry->session.AddDestination(jrtplib::RTPIPv4Address(destIp, destPort)) < 0) {
+            release(entry);
+            return nullptr;
+        }
+        return entry;
+    }
+
+    // 异步拆除：立即返回，BYE 和重建在后台线程完成
+    void release(PooledSession *entry) {
+        {
+            std::lock_guard<std::mutex> lock(reclaimMutex);
+            reclaim.push_back(entry);
+        }
+        reclaimCond.notify_one();
+    }
+
+    size_t available() {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        return idle.size();
+    }
+
+    /**
+     * @brief 处理完所有待回收会话后停止后台线程，再销毁空闲会话.
+     *
+     * 还没有 release() 的会话不碰 (调用方可能还在用)，只报告数量；
+     * 它们的内存仍归池所有，池析构后不能再使用。
+     */
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(reclaimMutex);
+            if (!running) {
+                return;
+            }
+            running = false;
+        }
+        reclaimCond.notify_all();
+        for (auto &t : workers) {
+            t.join();
+        }
+        workers.clear();
+        std::lock_guard<std::mutex> lock(idleMutex);
+        size_t inUse = all.size() - idle.size() - lost;
+        if (inUse > 0) {
+            std::cerr << "SessionPool: " << inUse << " session(s) not released before stop()" << std::endl;
+        }
+        for (PooledSession *entry : idle) {
+            entry->session.BYEDestroy(byeWait, "Session ended", 13);
+            closeSockets(*entry);
+        }
+        idle.clear();
+    }
+
+private:
+    int create(PooledSession &entry) {
+        jrtplib::RTPSessionParams sessparams;
+        sessparams.SetOwnTimestampUnit(timestampUnit);
+        sessparams.SetAcceptOwnPackets(true);
+        sessparams.SetUsePollThread(false);
+        jrtplib::RTPUDPv4TransmissionParams transparams;
+        transparams.SetUseExistingSockets(entry.rtpSocket, entry.rtcpSocket);
+        return entry.session.Create(sessparams, &transparams);
+    }
+
+    static int bindUdp(uint16_t port) {
+        int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd < 0) {
+            return -1;
+        }
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(port);
+        if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    static void closeSockets(PooledSession &entry) {
+        if (entry.rtpSocket >= 0) {
+            close(entry.rtpSocket);
+            entry.rtpSocket = -1;
+        }
+        if (entry.rtcpSocket >= 0) {
+            close(entry.rtcpSocket);
+            entry.rtcpSocket = -1;
+        }
+    }
+
+    void reclaimLoop() {
+        while (true) {
+            PooledSession *entry;
+            {
+                std::unique_lock<std::mutex> lock(reclaimMutex);
+                reclaimCond.wait(lock, [this] { return !reclaim.empty() || !running; });
+                if (reclaim.empty()) {
+                    return;
+                }
+                entry = reclaim.front();
+                reclaim.pop_front();
+            }
+
+            entry->session.BYEDestroy(byeWait, "Session ended", 13);
+            int status = create(*entry);
+            if (status < 0) {
+                // 重建失败，这个会话不再放回池中
+                std::cerr << "SessionPool: recreate on port " << entry->portbase << " failed: "
+                          << jrtplib::RTPGetErrorString(status) << std::endl;
+                closeSockets(*entry);
+                std::lock_guard<std::mutex> lock(idleMutex);
+                ++lost;
+                continue;
+            }
+
+            std::lock_guard<std::mutex> lock(idleMutex);
+            idle.push_back(entry);
+        }
+    }
+
+    uint16_t portbase;
+    size_t size;
+    double timestampUnit;
+    size_t reclaimThreads;
+    jrtplib::RTPTime byeWait;
+
+    std::vector<std::unique_ptr<PooledSession>> all;
+    std::vector<PooledSession *> idle;
+    size_t lost; // 重建失败、不再放回的会话数，受 idleMutex 保护
+    std::mutex idleMutex;
+
+    std::deque<PooledSession *> reclaim;
+    std::mutex reclaimMutex;
+    std::condition_variable reclaimCond;
+    std::vector<std::thread> workers;
+    bool running; // 受 reclaimMutex 保护
+};
+
+#endif // RTP_SESSION_POOL_H
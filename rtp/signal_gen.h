@@ -0,0 +1,406 @@
+#ifndef RTP_SIGNAL_GEN_H
+#define RTP_SIGNAL_GEN_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/*
+测试信号发生器：正弦、多音/DTMF、线性扫频、白噪声/粉红噪声。
+
+按 SIG_LANES 个连续样本一组生成：每个 lane 是一个复数旋转子，每步乘上 e^{i*LANES*w}，
+样本生成过程中只有乘加，没有 sin/cos 调用，可以放在实时回调里。
+三角函数只在设置频率、扫频重新开始时调用。
+旋转子的幅度误差会累积，每 SIG_RENORM_STEPS 步用一阶近似 (3 - |z|^2) / 2 拉回单位圆。
+输出为 [-1, 1] 的 float，sigToPcm16() 转 16 位 PCM。
+*/
+
+// GCC/Clang 向量扩展。宽度要与目标指令集一致，超过寄存器宽度时 GCC 会退化为逐元素标量运算
+#if defined(__AVX__)
+#define SIG_LANES 8
+#else
+#define SIG_LANES 4 // SSE2 / NEON
+#endif
+#define SIG_RENORM_STEPS 32
+
+typedef float SigVec __attribute__((vector_size(SIG_LANES * sizeof(float))));
+typedef uint32_t SigVecU __attribute__((vector_size(SIG_LANES * sizeof(uint32_t))));
+typedef int32_t SigVecI __attribute__((vector_size(SIG_LANES * sizeof(int32_t))));
+
+inline float sigDbovToAmplitude(double dbov) {
+    return static_cast<float>(std::pow(10.0, dbov / 20.0));
+}
+
+// float -> int16，饱和
+inline void sigToPcm16(const float *in, int16_t *out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        float v = in[i] * 32767.0f;
+        v = v > 32767.0f ? 32767.0f : (v < -32768.0f ? -32768.0f : v);
+        out[i] = static_cast<int16_t>(v);
+    }
+}
+
+/**
+ * @brief 生成器公共部分：按任意长度取样本，内部按 SIG_LANES 一组生成，多出的留到下次.
+ *
+ * Derived 需实现 void nextVec(SigVec &out)。
+ */
+template <typename Derived>
+class SigSource {
+public:
+    void generate(float *out, size_t n) {
+        size_t i = 0;
+        while (i < n && carry < SIG_LANES) {
+            out[i++] = carryBuf[carry++];
+        }
+        SigVec v;
+        for (; i + SIG_LANES <= n; i += SIG_LANES) {
+            static_cast<Derived *>(this)->nextVec(v);
+            memcpy(out + i, &v, sizeof(v));
+        }
+        if (i < n) {
+            static_cast<Derived *>(this)->nextVec(v);
+            memcpy(carryBuf, &v, sizeof(v));
+            carry = n - i;
+            memcpy(out + i, carryBuf, carry * sizeof(float));
+        }
+    }
+
+    void generatePcm16(int16_t *out, size_t n) {
+        float buf[256];
+        while (n > 0) {
+            size_t k = n < 256 ? n : 256;
+            generate(buf, k);
+            sigToPcm16(buf, out, k);
+            out += k;
+            n -= k;
+        }
+    }
+
+protected:
+    // 丢掉已生成但未取走的样本，参数变化时调用
+    void resetCarry() { carry = SIG_LANES; }
+
+    // 已生成但未取走的样本数
+    size_t pending() const { return SIG_LANES - carry; }
+
+private:
+    float carryBuf[SIG_LANES];
+    size_t carry = SIG_LANES;
+};
+
+// 正弦振荡器
+class Oscillator : public SigSource<Oscillator> {
+public:
+    Oscillator() : sampleRate(8000), amplitude(0), steps(0) { setPhase(0, 0); }
+
+    Oscillator(double freq, double sampleRate, float amplitude) :
+        sampleRate(sampleRate), amplitude(amplitude), steps(0) {
+        setPhase(freq, 0);
+    }
+
+    // 改变频率，相位连续：旋转子已越过未取走的样本，退回到下一个要输出的样本再换频率
+    void setFrequency(double freq) {
+        setPhase(freq, std::atan2(im[0], re[0]) - pending() * w);
+        resetCarry();
+    }
+
+    void setAmplitude(float a) { amplitude = a; }
+    float getAmplitude() const { return amplitude; }
+
+    void nextVec(SigVec &out) {
+        out = im * amplitude;
+        advance();
+    }
+
+    // 累加到 acc，多音合成用
+    void addVec(SigVec &acc) {
+        acc += im * amplitude;
+        advance();
+    }
+
+private:
+    void setPhase(double freq, double phase) {
+        w = 2 * M_PI * freq / sampleRate;
+        for (int k = 0; k < SIG_LANES; ++k) {
+            re[k] = static_cast<float>(std::cos(phase + k * w));
+            im[k] = static_cast<float>(std::sin(phase + k * w));
+        }
+        stepRe = static_cast<float>(std::cos(SIG_LANES * w));
+        stepIm = static_cast<float>(std::sin(SIG_LANES * w));
+    }
+
+    void advance() {
+        SigVec r = re * stepRe - im * stepIm;
+        im = re * stepIm + im * stepRe;
+        re = r;
+        if (++steps == SIG_RENORM_STEPS) {
+            steps = 0;
+            SigVec g = 1.5f - 0.5f * (re * re + im * im);
+            re *= g;
+            im *= g;
+        }
+    }
+
+    double sampleRate;
+    double w; // 每样本相位增量
+    float amplitude;
+    int steps;
+    SigVec re, im;
+    float stepRe, stepIm;
+};
+
+#define SIG_MAX_TONES 4
+
+// 最多 SIG_MAX_TONES 个正弦叠加
+class MultiTone : public SigSource<MultiTone> {
+public:
+    explicit MultiTone(double sampleRate = 8000) : sampleRate(sampleRate), count(0) {}
+
+    bool addTone(double freq, float amplitude) {
+        if (count == SIG_MAX_TONES) {
+            return false;
+        }
+        tones[count++] = Oscillator(freq, sampleRate, amplitude);
+        return true;
+    }
+
+    void clear() {
+        count = 0;
+        resetCarry();
+    }
+
+    Oscillator &tone(int i) { return tones[i]; }
+    int size() const { return count; }
+
+    void nextVec(SigVec &out) {
+        out = SigVec {};
+        for (int i = 0; i < count; ++i) {
+            tones[i].addVec(out);
+        }
+    }
+
+private:
+    double sampleRate;
+    int count;
+    Oscillator tones[SIG_MAX_TONES];
+};
+
+// DTMF 按键对应的低/高频
+inline bool dtmfFrequencies(char digit, double *low, double *high) {
+    static const char keys[] = "123A456B789C*0#D";
+    static const double rows[] = {697, 770, 852, 941};
+    static const double cols[] = {1209, 1336, 1477, 1633};
+    const char *p = strchr(keys, digit);
+    if (!p || digit == 0) {
+        return false;
+    }
+    int i = static_cast<int>(p - keys);
+    *low = rows[i / 4];
+    *high = cols[i % 4];
+    return true;
+}
+
+/**
+ * @brief 按键序列：每个键响 toneMs，间隔 gapMs，放完后输出静音.
+ *
+ * 低频组比高频组低 twistDb (正 twist)，电平 levelDbov 指高频组。
+ */
+class DtmfGenerator : public SigSource<DtmfGenerator> {
+public:
+    explicit DtmfGenerator(double sampleRate = 8000, int toneMs = 100, int gapMs = 100,
+                           double levelDbov = -10, double twistDb = 2) :
+        sampleRate(sampleRate), tones(sampleRate), digits(nullptr), index(0), pos(0),
+        toneSamples(static_cast<size_t>(sampleRate * toneMs / 1000)),
+        gapSamples(static_cast<size_t>(sampleRate * gapMs / 1000)),
+        high(sigDbovToAmplitude(levelDbov)), low(sigDbovToAmplitude(levelDbov - twistDb)) {}
+
+    // digits 需在播放期间保持有效
+    void start(const char *s) {
+        digits = s;
+        index = 0;
+        pos = 0;
+        loadDigit();
+        resetCarry();
+    }
+
+    bool done() const { return !digits || digits[index] == 0; }
+
+    void nextVec(SigVec &out) {
+        if (done()) {
+            out = SigVec {};
+            return;
+        }
+        if (pos + SIG_LANES <= toneSamples) {
+            tones.nextVec(out);
+        } else if (pos >= toneSamples) {
+            out = SigVec {};
+        } else {
+            // 跨越 响/停 边界的一组，逐 lane 置零
+            tones.nextVec(out);
+            for (int k = 0; k < SIG_LANES; ++k) {
+                if (pos + k >= toneSamples) {
+                    out[k] = 0;
+                }
+            }
+        }
+        pos += SIG_LANES;
+        if (pos >= toneSamples + gapSamples) {
+            ++index;
+            pos = 0;
+            loadDigit();
+        }
+    }
+
+private:
+    void loadDigit() {
+        tones.clear();
+        double lo, hi;
+        while (digits[index] && !dtmfFrequencies(digits[index], &lo, &hi)) {
+            ++index; // 跳过无效字符
+        }
+        if (digits[index]) {
+            tones.addTone(lo, low);
+            tones.addTone(hi, high);
+        }
+    }
+
+    double sampleRate;
+    MultiTone tones;
+    const char *digits;
+    size_t index;
+    size_t pos;
+    size_t toneSamples;
+    size_t gapSamples;
+    float high;
+    float low;
+};
+
+/**
+ * @brief 线性扫频 f0 -> f1，持续 seconds 后从头开始.
+ *
+ * 相位 φ(n) = a*n + b*n^2，lane 每步乘 r_n = e^{i(φ(n+L) - φ(n))}，
+ * r_n 本身也是旋转子：r_{n+L} = r_n * e^{i*2*L*L*b}。
+ */
+class Sweep : public SigSource<Sweep> {
+public:
+    Sweep(double f0, double f1, double seconds, double sampleRate, float amplitude) :
+        amplitude(amplitude), length(static_cast<size_t>(seconds * sampleRate)), pos(0), steps(0) {
+        a = 2 * M_PI * f0 / sampleRate;
+        b = M_PI * (f1 - f0) / seconds / (sampleRate * sampleRate);
+        double dd = 2.0 * SIG_LANES * SIG_LANES * b;
+        ddRe = static_cast<float>(std::cos(dd));
+        ddIm = static_cast<float>(std::sin(dd));
+        restart();
+    }
+
+    void nextVec(SigVec &out) {
+        out = zIm * amplitude;
+        SigVec t = zRe * rRe - zIm * rIm;
+        zIm = zRe * rIm + zIm * rRe;
+        zRe = t;
+        t = rRe * ddRe - rIm * ddIm;
+        rIm = rRe * ddIm + rIm * ddRe;
+        rRe = t;
+        if (++steps == SIG_RENORM_STEPS) {
+            steps = 0;
+            SigVec g = 1.5f - 0.5f * (zRe * zRe + zIm * zIm);
+            zRe *= g;
+            zIm *= g;
+            g = 1.5f - 0.5f * (rRe * rRe + rIm * rIm);
+            rRe *= g;
+            rIm *= g;
+        }
+        pos += SIG_LANES;
+        if (pos >= length) {
+            restart();
+        }
+    }
+
+private:
+    void restart() {
+        pos = 0;
+        steps = 0;
+        for (int k = 0; k < SIG_LANES; ++k) {
+            double phase = a * k + b * k * k;
+            double step = a * SIG_LANES + b * (2.0 * SIG_LANES * k + SIG_LANES * SIG_LANES);
+            zRe[k] = static_cast<float>(std::cos(phase));
+            zIm[k] = static_cast<float>(std::sin(phase));
+            rRe[k] = static_cast<float>(std::cos(step));
+            rIm[k] = static_cast<float>(std::sin(step));
+        }
+    }
+
+    float amplitude;
+    size_t length;
+    size_t pos;
+    int steps;
+    double a, b;
+    float ddRe, ddIm;
+    SigVec zRe, zIm, rRe, rIm;
+};
+
+// 均匀白噪声，每个 lane 一个 xorshift32
+class WhiteNoise : public SigSource<WhiteNoise> {
+public:
+    WhiteNoise(float amplitude = 1.0f, uint32_t seed = 1) : amplitude(amplitude) {
+        for (int k = 0; k < SIG_LANES; ++k) {
+            // 不同 lane 用不同种子，避免相关；xorshift 的状态不能为 0
+            uint32_t s = seed * 2654435761u + k * 0x9e3779b9u;
+            state[k] = s ? s : 0x12345678u;
+        }
+    }
+
+    void setAmplitude(float a) { amplitude = a; }
+
+    void nextVec(SigVec &out) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        // 有符号 32 位 -> [-1, 1)
+        out = __builtin_convertvector(reinterpret_cast<SigVecI &>(state), SigVec) * (amplitude / 2147483648.0f);
+    }
+
+private:
+    float amplitude;
+    SigVecU state;
+};
+
+/**
+ * @brief 粉红噪声 (-3 dB/倍频程)，白噪声经 Paul Kellet 的 7 极点滤波.
+ *
+ * IIR 只能按样本顺序计算，白噪声部分仍按向量生成。作舒适噪声用。
+ */
+class PinkNoise : public SigSource<PinkNoise> {
+public:
+    PinkNoise(float amplitude = 1.0f, uint32_t seed = 1) :
+        white(1.0f, seed), amplitude(amplitude * 0.11f) { // 0.11 把滤波增益归一到约 ±1
+        memset(b, 0, sizeof(b));
+    }
+
+    void setAmplitude(float a) { amplitude = a * 0.11f; }
+
+    void nextVec(SigVec &out) {
+        SigVec w;
+        white.nextVec(w);
+        for (int k = 0; k < SIG_LANES; ++k) {
+            float x = w[k];
+            b[0] = 0.99886f * b[0] + x * 0.0555179f;
+            b[1] = 0.99332f * b[1] + x * 0.0750759f;
+            b[2] = 0.96900f * b[2] + x * 0.1538520f;
+            b[3] = 0.86650f * b[3] + x * 0.3104856f;
+            b[4] = 0.55000f * b[4] + x * 0.5329522f;
+            b[5] = -0.7616f * b[5] - x * 0.0168980f;
+            out[k] = (b[0] + b[1] + b[2] + b[3] + b[4] + b[5] + b[6] + x * 0.5362f) * amplitude;
+            b[6] = x * 0.115926f;
+        }
+    }
+
+private:
+    WhiteNoise white;
+    float amplitude;
+    float b[7];
+};
+
+#endif // RTP_SIGNAL_GEN_H
@@ -0,0 +1,210 @@
+#ifndef RTP_SSRC_MAP_H
+#define RTP_SSRC_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+/*
+SSRC -> 每个源的管道状态 (抖动缓冲、解码器、统计) 的开放寻址哈希表。
+
+- 线性探测 + 后移删除 (backward-shift)，没有墓碑，长时间运行不会退化；
+- 每个槽位按 64 字节缓存行对齐，一次查找通常只触碰一条缓存行；
+- 单写者设计：表归接收线程所有，接收路径上的查找/插入不加锁；
+  按原始 UDP 包的 SSRC 和源地址查表 (见 demux.cc)，表本身就是解复用，不再经过 JRTPLIB 的源表；
+- 同一 SSRC 来自不同传输地址时按 RFC 3550 8.2 视为冲突，保留原有源；
+- evictIdle() 按超时淘汰不活跃的源 (RFC 3550 6.3.5 建议 5 个 RTCP 周期)。
+*/
+
+#define SSRC_MAP_CACHE_LINE 64
+
+template <typename State>
+class SsrcMap {
+public:
+    enum Result {
+        SSRC_FOUND,     // 已有的源
+        SSRC_INSERTED,  // 新源，状态已默认构造
+        SSRC_COLLISION, // SSRC 相同但传输地址不同
+        SSRC_FULL       // 表已满 (超过最大负载因子)
+    };
+
+    struct alignas(SSRC_MAP_CACHE_LINE) Slot {
+        uint32_t ssrc;
+        uint32_t used;
+        uint32_t addr;   // 主机字节序 IPv4
+        uint16_t port;
+        int64_t lastSeen; // 调用者提供的单调时钟 (ms)
+        State state;
+    };
+
+    // maxSources: 预期同时存在的最大源数，表容量取不小于 2 倍的 2 的幂
+    explicit SsrcMap(size_t maxSources) : slots(nullptr), mask(0), count(0), limit(0) {
+        size_t cap = 16;
+        while (cap < maxSources * 2) {
+            cap <<= 1;
+        }
+        void *mem = nullptr;
+        if (posix_memalign(&mem, SSRC_MAP_CACHE_LINE, cap * sizeof(Slot)) != 0) {
+            throw std::bad_alloc();
+        }
+        slots = static_cast<Slot *>(mem);
+        for (size_t i = 0; i < cap; ++i) {
+            slots[i].used = 0;
+        }
+        mask = cap - 1;
+        limit = cap / 4 * 3;
+    }
+
+    ~SsrcMap() {
+        clear();
+        free(slots);
+    }
+
+    SsrcMap(const SsrcMap &) = delete;
+    SsrcMap &operator=(const SsrcMap &) = delete;
+
+    // 只读查找，不存在返回 nullptr
+    State *find(uint32_t ssrc) {
+        for (size_t i = hash(ssrc) & mask;; i = (i + 1) & mask) {
+            Slot &s = slots[i];
+            if (!s.used) {
+                return nullptr;
+            }
+            if (s.ssrc == ssrc) {
+                return &s.state;
+            }
+        }
+    }
+
+    // 接收路径入口：查找或插入，并刷新活跃时间
+    State *lookup(uint32_t ssrc, uint32_t addr, uint16_t port, int64_t now, Result *result) {
+        size_t i = hash(ssrc) & mask;
+        for (;; i = (i + 1) & mask) {
+            Slot &s = slots[i];
+            if (!s.used) {
+                break;
+            }
+            if (s.ssrc == ssrc) {
+                if (s.addr != addr || s.port != port) {
+                    *result = SSRC_COLLISION;
+                    return nullptr;
+                }
+                s.lastSeen = now;
+                *result = SSRC_FOUND;
+                return &s.state;
+            }
+        }
+        if (count >= limit) {
+            *result = SSRC_FULL;
+            return nullptr;
+        }
+        Slot &s = slots[i];
+        new (&s.state) State();
+        s.ssrc = ssrc;
+        s.addr = addr;
+        s.port = port;
+        s.lastSeen = now;
+        s.used = 1;
+        ++count;
+        *result = SSRC_INSERTED;
+        return &s.state;
+    }
+
+    // 收到 BYE 时调用
+    bool erase(uint32_t ssrc) {
+        for (size_t i = hash(ssrc) & mask;; i = (i + 1) & mask) {
+            if (!slots[i].used) {
+                return false;
+            }
+            if (slots[i].ssrc == ssrc) {
+                removeAt(i);
+                return true;
+            }
+        }
+    }
+
+    // 淘汰 lastSeen 早于 now - timeout 的源，onEvict(ssrc, state) 在析构前调用
+    template <typename F>
+    size_t evictIdle(int64_t now, int64_t timeout, F onEvict) {
+        size_t evicted = 0;
+        for (size_t i = 0; i <= mask; ++i) {
+            // 后移删除会把后面的元素挪到 i，需要重新检查同一位置
+            while (slots[i].used && now - slots[i].lastSeen > timeout) {
+                onEvict(slots[i].ssrc, slots[i].state);
+                removeAt(i);
+                ++evicted;
+            }
+        }
+        return evicted;
+    }
+
+    size_t evictIdle(int64_t now, int64_t timeout) {
+        return evictIdle(now, timeout, [](uint32_t, State &) {});
+    }
+
+    template <typename F>
+    void forEach(F f) {
+        for (size_t i = 0; i <= mask; ++i) {
+            if (slots[i].used) {
+                f(slots[i].ssrc, slots[i].state);
+            }
+        }
+    }
+
+    void clear() {
+        for (size_t i = 0; i <= mask; ++i) {
+            if (slots[i].used) {
+                slots[i].state.~State();
+                slots[i].used = 0;
+            }
+        }
+        count = 0;
+    }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return mask + 1; }
+    size_t memoryBytes() const { return capacity() * sizeof(Slot); }
+
+private:
+    // murmur3 fmix32：SSRC 可能由对端任意选择，不能直接取低位
+    static uint32_t hash(uint32_t x) {
+        x ^= x >> 16;
+        x *= 0x85ebca6bu;
+        x ^= x >> 13;
+        x *= 0xc2b2ae35u;
+        x ^= x >> 16;
+        return x;
+    }
+
+    void removeAt(size_t hole) {
+        slots[hole].state.~State();
+        slots[hole].used = 0;
+        --count;
+        for (size_t j = (hole + 1) & mask; slots[j].used; j = (j + 1) & mask) {
+            size_t home = hash(slots[j].ssrc) & mask;
+            // home 不在 (hole, j] 区间内时，元素可以前移填补空洞
+            if (((j - home) & mask) >= ((j - hole) & mask)) {
+                Slot &dst = slots[hole];
+                Slot &src = slots[j];
+                new (&dst.state) State(std::move(src.state));
+                dst.ssrc = src.ssrc;
+                dst.addr = src.addr;
+                dst.port = src.port;
+                dst.lastSeen = src.lastSeen;
+                dst.used = 1;
+                src.state.~State();
+                src.used = 0;
+                hole = j;
+            }
+        }
+    }
+
+    Slot *slots;
+    size_t mask;
+    size_t count;
+    size_t limit;
+};
+
+#endif // RTP_SSRC_MAP_H
@@ -0,0 +1,568 @@
+#ifndef RTP_TONE_DETECT_H
+#define RTP_TONE_DETECT_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "rtp_packet.h"
+
+/*
+带内 DTMF / 信号音检测，多路呼叫批量处理。
+
+每个块 TONE_BLOCK 个样本 (8kHz 下 12.75ms)，对 8 个 DTMF 频率和最多 TONE_MAX_CUSTOM 个
+自定义频率 (拨号音、回铃音、传真 CED/CNG 等) 各跑一个 Goertzel 滤波器。
+状态按 [滤波器][呼叫] 的结构数组存放，向量的每个 lane 是一路呼叫，
+一条乘加同时推进 TONE_LANES 路呼叫的同一个滤波器；各路按同一时钟送帧 (每 20ms 一帧)。
+块结束后逐路判决，判决只在块边界做，开销可忽略。
+
+DTMF 判决 (Q.24 默认值，可改)：
+- 行/列各自最大的频率功率超过最低电平；
+- 同组第二大的频率比最大的低 DTMF_RELATIVE_PEAK 以上；
+- 两个频率的能量占块内总能量的 DTMF_TONE_TO_TOTAL 以上 (排除语音和部分块)；
+- 高频组相对低频组的电平差在 [-twistLowDb, +twistHighDb] 内；
+- 连续 DTMF_ON_BLOCKS 块相同才算按下 (约 25ms，≥40ms 的按键一定检测到，≤20ms 的拒绝)；
+  连续 DTMF_OFF_BLOCKS 块不满足才算松开 (≤10ms 的中断不会拆成两个按键)。
+*/
+
+#if defined(__AVX__)
+#define TONE_LANES 8
+#else
+#define TONE_LANES 4 // SSE2 / NEON
+#endif
+
+#define TONE_BLOCK 102
+#define TONE_DTMF_FILTERS 8
+#define TONE_MAX_CUSTOM 8
+#define TONE_FILTERS (TONE_DTMF_FILTERS + TONE_MAX_CUSTOM)
+
+#define DTMF_ON_BLOCKS 2
+#define DTMF_OFF_BLOCKS 3
+#define DTMF_RELATIVE_PEAK 4.0f   // 6 dB
+#define DTMF_TONE_TO_TOTAL 0.8f
+#define DTMF_MIN_LEVEL_DBOV (-36.0)
+#define DTMF_TWIST_HIGH_DB 4.0    // 高频组可以比低频组高 4 dB
+#define DTMF_TWIST_LOW_DB 8.0     // 高频组可以比低频组低 8 dB
+#define TONE_TO_TOTAL 0.6f
+#define TONE_OFF_BLOCKS 3
+
+typedef float ToneVec __attribute__((vector_size(TONE_LANES * sizeof(float))));
+
+// ----------------------- RFC 4733 -----------------------
+
+#define RFC4733_PAYLOAD_SIZE 4
+#define RFC4733_EVENT_ANS 32      // 2100Hz 应答音
+#define RFC4733_EVENT_CNG 36      // 1100Hz 传真主叫音
+#define RFC4733_END_REPEATS 3
+#define RFC4733_PACKET_SIZE (RTP_HEADER_SIZE + RFC4733_PAYLOAD_SIZE)
+#define RFC4733_UPDATE_SAMPLES 400 // 8kHz 下每 50ms 一个持续时间更新
+
+// '0'-'9' -> 0-9, '*' -> 10, '#' -> 11, 'A'-'D' -> 12-15，非法返回 -1
+inline int dtmfEventCode(char digit) {
+    if (digit >= '0' && digit <= '9') {
+        return digit - '0';
+    }
+    if (digit == '*') {
+        return 10;
+    }
+    if (digit == '#') {
+        return 11;
+    }
+    if (digit >= 'A' && digit <= 'D') {
+        return 12 + digit - 'A';
+    }
+    return -1;
+}
+
+inline char dtmfEventDigit(int event) {
+    static const char digits[] = "0123456789*#ABCD";
+    return event >= 0 && event < 16 ? digits[event] : '?';
+}
+
+// telephone-event 负载：event | E R volume(6) | duration(16)
+inline void rfc4733Write(uint8_t *out, uint8_t event, bool end, uint8_t volume, uint16_t duration) {
+    out[0] = event;
+    out[1] = static_cast<uint8_t>((end ? 0x80 : 0) | (volume & 0x3f));
+    out[2] = static_cast<uint8_t>(duration >> 8);
+    out[3] = static_cast<uint8_t>(duration);
+}
+
+inline bool rfc4733Read(const uint8_t *p, size_t len, uint8_t *event, bool *end, uint8_t *volume, uint16_t *duration) {
+    if (len < RFC4733_PAYLOAD_SIZE) {
+        return false;
+    }
+    *event = p[0];
+    *end = (p[1] & 0x80) != 0;
+    *volume = p[1] & 0x3f;
+    *duration = static_cast<uint16_t>((p[2] << 8) | p[3]);
+    return true;
+}
+
+struct TelephoneEventPacket {
+    bool marker;        // 事件的第一个包
+    uint32_t timestamp; // 事件开始的 RTP 时间戳，同一事件的所有包相同
+    uint8_t payload[RFC4733_PAYLOAD_SIZE];
+};
+
+/**
+ * @brief 把检测到的事件转成 telephone-event 包序列.
+ *
+ * start() 发首包 (marker)，之后每个包间隔 update() 发一次持续时间更新，
+ * end() 发 RFC4733_END_REPEATS 个带 E 位的结束包。
+ * 持续时间超过 16 位上限时停在 0xFFFF (RFC 4733 2.5.1.3 的分段未实现)。
+ */
+class TelephoneEventSender {
+public:
+    TelephoneEventSender() : active(false), event(0), volume(0), timestamp(0) {}
+
+    void start(uint8_t ev, uint32_t ts, uint8_t vol, uint32_t duration, TelephoneEventPacket &p) {
+        active = true;
+        event = ev;
+        volume = vol;
+        timestamp = ts;
+        fill(p, true, false, duration);
+    }
+
+    bool update(uint32_t duration, TelephoneEventPacket &p) {
+        if (!active) {
+            return false;
+        }
+        fill(p, false, false, duration);
+        return true;
+    }
+
+    int end(uint32_t duration, TelephoneEventPacket p[RFC4733_END_REPEATS]) {
+        if (!active) {
+            return 0;
+        }
+        for (int i = 0; i < RFC4733_END_REPEATS; ++i) {
+            fill(p[i], false, true, duration);
+        }
+        active = false;
+        return RFC4733_END_REPEATS;
+    }
+
+    bool isActive() const { return active; }
+
+private:
+    void fill(TelephoneEventPacket &p, bool marker, bool end, uint32_t duration) {
+        p.marker = marker;
+        p.timestamp = timestamp;
+        rfc4733Write(p.payload, event, end, volume, static_cast<uint16_t>(duration > 0xffff ? 0xffff : duration));
+    }
+
+    bool active;
+    uint8_t event;
+    uint8_t volume;
+    uint32_t timestamp;
+};
+
+// ----------------------- 检测 -----------------------
+
+struct ToneEvent {
+    uint32_t stream;
+    uint8_t event;      // RFC 4733 事件码
+    bool end;           // false: 开始，true: 结束
+    uint64_t start;     // 开始时的样本序号 (检测器时钟)
+    uint32_t duration;  // 结束时为总时长，开始时为已持续的样本数
+    uint8_t volume;     // RFC 4733 音量，-dBm0
+};
+
+struct TelephoneEventRtp {
+    uint8_t bytes[RFC4733_PACKET_SIZE];
+};
+
+/**
+ * @brief 一路呼叫的检测事件转成完整的 telephone-event RTP 包，由调用方发出.
+ *
+ * 独立的 SSRC/序列号空间，每个包序列号加一。时间戳为 tsBase + 事件开始的样本序号，
+ * 同一事件的首包 (M 位)、更新包和 RFC4733_END_REPEATS 个结束包时间戳相同。
+ * 检测器时钟每推进 updateSamples 发一个持续时间更新。
+ * 同时只发一个事件：新事件开始时先结束当前事件，之后当前事件的结束通知忽略。
+ */
+class TelephoneEventStream {
+public:
+    TelephoneEventStream(uint8_t payloadType, uint32_t ssrc, uint16_t seq = 0, uint32_t tsBase = 0,
+                         uint32_t updateSamples = RFC4733_UPDATE_SAMPLES) :
+        payloadType(payloadType), ssrc(ssrc), seq(seq), tsBase(tsBase), updateSamples(updateSamples),
+        event(0), eventStart(0), lastSent(0) {}
+
+    // 处理 ToneDetectorBank 给出的一个事件，产生的包追加到 out
+    void onEvent(const ToneEvent &e, std::vector<TelephoneEventRtp> &out);
+
+    // 检测器时钟推进到 now (ToneDetectorBank::now())，事件进行中时按间隔发更新
+    void advance(uint64_t now, std::vector<TelephoneEventRtp> &out) {
+        if (sender.isActive() && now >= lastSent + updateSamples) {
+            lastSent = now;
+            TelephoneEventPacket p;
+            sender.update(static_cast<uint32_t>(now - eventStart), p);
+            emit(p, out);
+        }
+    }
+
+    bool isActive() const { return sender.isActive(); }
+
+private:
+    void finish(uint32_t duration, std::vector<TelephoneEventRtp> &out) {
+        TelephoneEventPacket p[RFC4733_END_REPEATS];
+        int n = sender.end(duration, p);
+        for (int i = 0; i < n; ++i) {
+            emit(p[i], out);
+        }
+    }
+
+    void emit(const TelephoneEventPacket &p, std::vector<TelephoneEventRtp> &out) {
+        RtpHeader h;
+        h.marker = p.marker;
+        h.payloadType = payloadType;
+        h.seq = seq++;
+        h.timestamp = p.timestamp;
+        h.ssrc = ssrc;
+        out.emplace_back();
+        rtpBuildPacket(out.back().bytes, RFC4733_PACKET_SIZE, h, p.payload, RFC4733_PAYLOAD_SIZE);
+    }
+
+    uint8_t payloadType;
+    uint32_t ssrc;
+    uint16_t seq;
+    uint32_t tsBase;
+    uint32_t updateSamples;
+    TelephoneEventSender sender;
+    uint8_t event;
+    uint64_t eventStart;
+    uint64_t lastSent; // 最后一个包对应的检测器时钟
+};
+
+inline void TelephoneEventStream::onEvent(const ToneEvent &e, std::vector<TelephoneEventRtp> &out) {
+    if (!e.end) {
+        if (sender.isActive()) {
+            finish(static_cast<uint32_t>(e.start > eventStart ? e.start - eventStart : 0), out);
+        }
+        TelephoneEventPacket p;
+        sender.start(e.event, tsBase + static_cast<uint32_t>(e.start), e.volume, e.duration, p);
+        event = e.event;
+        eventStart = e.start;
+        lastSent = e.start + e.duration;
+        emit(p, out);
+    } else if (sender.isActive() && e.event == event) {
+        finish(e.duration, out);
+    }
+}
+
+class ToneDetectorBank {
+public:
+    explicit ToneDetectorBank(size_t maxStreams, double sampleRate = 8000) :
+        sampleRate(sampleRate), maxStreams(maxStreams), groups((maxStreams + TONE_LANES - 1) / TONE_LANES),
+        filters(TONE_DTMF_FILTERS), customCount(0), blockPos(0), clock(0),
+        s1(groups * TONE_FILTERS), s2(groups * TONE_FILTERS), energy(groups),
+        streams(groups * TONE_LANES) {
+        static const double dtmf[TONE_DTMF_FILTERS] = {697, 770, 852, 941, 1209, 1336, 1477, 1633};
+        for (int f = 0; f < TONE_DTMF_FILTERS; ++f) {
+            coef[f] = static_cast<float>(2 * std::cos(2 * M_PI * dtmf[f] / sampleRate));
+        }
+        // 单个正弦在块内的 Goertzel 功率约为 (A * N / 2)^2
+        double a = std::pow(10.0, DTMF_MIN_LEVEL_DBOV / 20.0) * TONE_BLOCK / 2;
+        minPower = static_cast<float>(a * a);
+        twistHigh = static_cast<float>(std::pow(10.0, DTMF_TWIST_HIGH_DB / 10.0));
+        twistLow = static_cast<float>(std::pow(10.0, DTMF_TWIST_LOW_DB / 10.0));
+        clearState();
+    }
+
+    /**
+     * @brief 增加一个自定义单频检测，持续 minMs 以上上报为 event.
+     * @return 滤波器序号，已满返回 -1.
+     */
+    int addTone(double freq, int minMs, uint8_t event) {
+        if (customCount == TONE_MAX_CUSTOM) {
+            return -1;
+        }
+        int i = customCount++;
+        coef[TONE_DTMF_FILTERS + i] = static_cast<float>(2 * std::cos(2 * M_PI * freq / sampleRate));
+        custom[i].minBlocks = static_cast<uint32_t>((minMs * sampleRate / 1000 + TONE_BLOCK - 1) / TONE_BLOCK);
+        custom[i].event = event;
+        filters = TONE_DTMF_FILTERS + customCount;
+        clearState();
+        return i;
+    }
+
+    // 调整 twist 门限 (dB)，默认 DTMF_TWIST_HIGH_DB / DTMF_TWIST_LOW_DB
+    void setTwist(double highDb, double lowDb) {
+        twistHigh = static_cast<float>(std::pow(10.0, highDb / 10.0));
+        twistLow = static_cast<float>(std::pow(10.0, lowDb / 10.0));
+    }
+
+    size_t capacity() const { return maxStreams; }
+
+    void open(size_t stream) {
+        streams[stream] = StreamState();
+        streams[stream].active = true;
+    }
+
+    void close(size_t stream) { streams[stream].active = false; }
+
+    uint64_t now() const { return clock; }
+
+    /**
+     * @brief 所有呼叫各送 n 个样本.
+     * @param frames capacity() 个指针，nullptr 视为静音
+     * @param events 追加检测到的开始/结束事件
+     */
+    void process(const int16_t *const *frames, size_t n, std::vector<ToneEvent> &events) {
+        size_t i = 0;
+        while (i < n) {
+            size_t chunk = n - i < TONE_BLOCK - blockPos ? n - i : TONE_BLOCK - blockPos;
+            for (size_t g = 0; g < groups; ++g) {
+                runGroup(g, frames, i, chunk);
+            }
+            i += chunk;
+            blockPos += chunk;
+            clock += chunk;
+            if (blockPos == TONE_BLOCK) {
+                for (size_t g = 0; g < groups; ++g) {
+                    finishGroup(g, events);
+                }
+                blockPos = 0;
+            }
+        }
+    }
+
+private:
+    struct CustomTone {
+        uint32_t minBlocks;
+        uint8_t event;
+    };
+
+    struct StreamState {
+        bool active = false;
+        int8_t candidate = -1;     // 上一块的判决
+        uint8_t candidateBlocks = 0;
+        int8_t digit = -1;         // 当前按下的键
+        uint8_t misses = 0;
+        uint64_t digitStart = 0;
+        float level = 0;           // 按键期间高频组的幅度
+        uint32_t customBlocks[TONE_MAX_CUSTOM] = {};
+        uint8_t customMisses[TONE_MAX_CUSTOM] = {};
+        bool customOn[TONE_MAX_CUSTOM] = {};
+        float customLevel[TONE_MAX_CUSTOM] = {};
+    };
+
+    void clearState() {
+        for (size_t i = 0; i < s1.size(); ++i) {
+            s1[i] = ToneVec {};
+            s2[i] = ToneVec {};
+        }
+        for (auto &e : energy) {
+            e = ToneVec {};
+        }
+        blockPos = 0;
+    }
+
+    bool groupActive(size_t g) const {
+        for (int k = 0; k < TONE_LANES; ++k) {
+            if (streams[g * TONE_LANES + k].active) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void runGroup(size_t g, const int16_t *const *frames, size_t off, size_t n) {
+        if (!groupActive(g)) {
+            return;
+        }
+        static const int16_t silence[TONE_BLOCK] = {};
+        const int16_t *in[TONE_LANES];
+        for (int k = 0; k < TONE_LANES; ++k) {
+            size_t s = g * TONE_LANES + k;
+            const int16_t *f = s < maxStreams && streams[s].active ? frames[s] : nullptr;
+            in[k] = f ? f + off : silence;
+        }
+
+        ToneVec a[TONE_FILTERS], b[TONE_FILTERS];
+        memcpy(a, &s1[g * TONE_FILTERS], filters * sizeof(ToneVec));
+        memcpy(b, &s2[g * TONE_FILTERS], filters * sizeof(ToneVec));
+        ToneVec e = energy[g];
+
+        for (size_t j = 0; j < n; ++j) {
+            // 转置：每个 lane 取一路呼叫的第 j 个样本
+            ToneVec x;
+            for (int k = 0; k < TONE_LANES; ++k) {
+                x[k] = in[k][j];
+            }
+            x *= 1.0f / 32768;
+            e += x * x;
+            for (int f = 0; f < filters; ++f) {
+                ToneVec t = x + coef[f] * a[f] - b[f];
+                b[f] = a[f];
+                a[f] = t;
+            }
+        }
+
+        memcpy(&s1[g * TONE_FILTERS], a, filters * sizeof(ToneVec));
+        memcpy(&s2[g * TONE_FILTERS], b, filters * sizeof(ToneVec));
+        energy[g] = e;
+    }
+
+    void finishGroup(size_t g, std::vector<ToneEvent> &events) {
+        ToneVec *a = &s1[g * TONE_FILTERS];
+        ToneVec *b = &s2[g * TONE_FILTERS];
+        ToneVec power[TONE_FILTERS];
+        for (int f = 0; f < filters; ++f) {
+            power[f] = a[f] * a[f] + b[f] * b[f] - coef[f] * a[f] * b[f];
+            a[f] = ToneVec {};
+            b[f] = ToneVec {};
+        }
+        ToneVec e = energy[g];
+        energy[g] = ToneVec {};
+
+        for (int k = 0; k < TONE_LANES; ++k) {
+            size_t s = g * TONE_LANES + k;
+            if (!streams[s].active) {
+                continue;
+            }
+            float p[TONE_FILTERS];
+            for (int f = 0; f < filters; ++f) {
+                p[f] = power[f][k];
+            }
+            // 功率换算成块能量：正弦能量 A^2 N / 2 = 功率 * 2 / N
+            float total = e[k] * TONE_BLOCK / 2;
+            decideDtmf(s, p, total, events);
+            decideCustom(s, p, total, events);
+        }
+    }
+
+    // 返回 0-15 的键序号 (行 * 4 + 列)，不是 DTMF 返回 -1
+    int classify(const float *p, float total, float *highPower) const {
+        int row = 0;
+        int col = 4;
+        for (int f = 1; f < 4; ++f) {
+            row = p[f] > p[row] ? f : row;
+            col = p[f + 4] > p[col] ? f + 4 : col;
+        }
+        if (p[row] < minPower || p[col] < minPower) {
+            return -1;
+        }
+        if (p[col] > p[row] * twistHigh || p[row] > p[col] * twistLow) {
+            return -1;
+        }
+        for (int f = 0; f < 4; ++f) {
+            if ((f != row && p[f] * DTMF_RELATIVE_PEAK > p[row]) ||
+                (f + 4 != col && p[f + 4] * DTMF_RELATIVE_PEAK > p[col])) {
+                return -1;
+            }
+        }
+        if (p[row] + p[col] < DTMF_TONE_TO_TOTAL * total) {
+            return -1;
+        }
+        *highPower = p[col];
+        return row * 4 + col - 4;
+    }
+
+    void decideDtmf(size_t s, const float *p, float total, std::vector<ToneEvent> &events) {
+        static const uint8_t keyEvent[16] = {1, 2, 3, 12, 4, 5, 6, 13, 7, 8, 9, 14, 10, 0, 11, 15};
+        StreamState &st = streams[s];
+        float high = 0;
+        int key = classify(p, total, &high);
+        uint64_t blockStart = clock - TONE_BLOCK;
+
+        if (st.digit >= 0) {
+            if (key == st.digit) {
+                st.misses = 0;
+                return;
+            }
+            if (++st.misses < DTMF_OFF_BLOCKS) {
+                return;
+            }
+            // 结束时间算到第一个不满足的块
+            uint64_t end = blockStart - (DTMF_OFF_BLOCKS - 1) * TONE_BLOCK;
+            pushEvent(events, s, keyEvent[st.digit], true, st.digitStart,
+                      static_cast<uint32_t>(end - st.digitStart), st.level);
+            st.digit = -1;
+            st.misses = 0;
+            st.candidate = -1;
+            st.candidateBlocks = 0;
+        }
+
+        if (key >= 0 && key == st.candidate) {
+            ++st.candidateBlocks;
+        } else {
+            st.candidate = static_cast<int8_t>(key);
+            st.candidateBlocks = 1;
+        }
+        if (key >= 0 && st.candidateBlocks >= DTMF_ON_BLOCKS) {
+            st.digit = static_cast<int8_t>(key);
+            st.digitStart = blockStart - (DTMF_ON_BLOCKS - 1) * TONE_BLOCK;
+            st.level = std::sqrt(high) * 2 / TONE_BLOCK;
+            st.misses = 0;
+            pushEvent(events, s, keyEvent[key], false, st.digitStart,
+                      static_cast<uint32_t>(clock - st.digitStart), st.level);
+        }
+    }
+
+    void decideCustom(size_t s, const float *p, float total, std::vector<ToneEvent> &events) {
+        StreamState &st = streams[s];
+        uint64_t blockStart = clock - TONE_BLOCK;
+        for (int i = 0; i < customCount; ++i) {
+            float power = p[TONE_DTMF_FILTERS + i];
+            // 呼叫进程音常是双频 (如 350+440)，每个频率单独配置，只要求占总能量的一部分
+            bool present = power >= minPower && power >= TONE_TO_TOTAL * total / 2;
+            if (present) {
+                // 短暂中断算在持续时间里
+                st.customBlocks[i] += st.customMisses[i] + 1;
+                st.customMisses[i] = 0;
+                if (!st.customOn[i] && st.customBlocks[i] >= custom[i].minBlocks) {
+                    st.customOn[i] = true;
+                    st.customLevel[i] = std::sqrt(power) * 2 / TONE_BLOCK;
+                    uint64_t start = clock - static_cast<uint64_t>(st.customBlocks[i]) * TONE_BLOCK;
+                    pushEvent(events, s, custom[i].event, false, start,
+                              static_cast<uint32_t>(clock - start), st.customLevel[i]);
+                }
+            } else if (st.customBlocks[i] > 0 && ++st.customMisses[i] >= TONE_OFF_BLOCKS) {
+                if (st.customOn[i]) {
+                    uint64_t start = blockStart - (TONE_OFF_BLOCKS - 1 + static_cast<uint64_t>(st.customBlocks[i])) * TONE_BLOCK;
+                    pushEvent(events, s, custom[i].event, true, start,
+                              st.customBlocks[i] * TONE_BLOCK, st.customLevel[i]);
+                }
+                st.customOn[i] = false;
+                st.customBlocks[i] = 0;
+                st.customMisses[i] = 0;
+            }
+        }
+    }
+
+    static void pushEvent(std::vector<ToneEvent> &events, size_t s, uint8_t event, bool end,
+                          uint64_t start, uint32_t duration, float amplitude) {
+        ToneEvent ev;
+        ev.stream = static_cast<uint32_t>(s);
+        ev.event = event;
+        ev.end = end;
+        ev.start = start;
+        ev.duration = duration;
+        // 满量程正弦约 +3.14 dBm0
+        int vol = amplitude > 0 ? static_cast<int>(-20 * std::log10(amplitude) - 3.14 + 0.5) : 63;
+        ev.volume = static_cast<uint8_t>(vol < 0 ? 0 : (vol > 63 ? 63 : vol));
+        events.push_back(ev);
+    }
+
+    double sampleRate;
+    size_t maxStreams;
+    size_t groups;
+    int filters;
+    int customCount;
+    size_t blockPos;
+    uint64_t clock;
+    float coef[TONE_FILTERS];
+    CustomTone custom[TONE_MAX_CUSTOM];
+    float minPower;
+    float twistHigh;
+    float twistLow;
+
+    std::vector<ToneVec> s1;
+    std::vector<ToneVec> s2;
+    std::vector<ToneVec> energy;
+    std::vector<StreamState> streams;
+};
+
+#endif // RTP_TONE_DETECT_H
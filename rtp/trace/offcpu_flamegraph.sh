@@ -0,0 +1,45 @@
+#!/bin/bash
+# 离 CPU (阻塞/等待) 时间火焰图：一个线程在哪些调用栈上被挂起、挂起了多久。
+# 用 -DCMAKE_BUILD_TYPE=Profile 编译，保留帧指针，用户态栈才完整。
+#
+# 用法: sudo ./offcpu_flamegraph.sh <pid> [秒数] [输出.svg]
+# 依赖: bcc (offcputime) 或 perf，以及 FlameGraph (flamegraph.pl 在 PATH 或 FLAMEGRAPH_DIR 中)
+
+set -e
+
+PID=$1
+SECONDS_TO_TRACE=${2:-10}
+OUT=${3:-offcpu-$PID.svg}
+
+if [ -z "$PID" ]; then
+    echo "usage: $0 <pid> [seconds] [output.svg]" >&2
+    exit 1
+fi
+
+FLAMEGRAPH=$(command -v flamegraph.pl || echo "${FLAMEGRAPH_DIR:-.}/flamegraph.pl")
+FOLDED=$(mktemp)
+trap 'rm -f "$FOLDED" "$FOLDED".data "$FOLDED".inj' EXIT
+
+OFFCPUTIME=$(command -v offcputime-bpfcc || command -v offcputime || true)
+if [ -n "$OFFCPUTIME" ]; then
+    # -f 直接输出折叠栈，值为微秒
+    "$OFFCPUTIME" -df -p "$PID" "$SECONDS_TO_TRACE" > "$FOLDED"
+    COUNTNAME=us
+else
+    # perf 方案：需要 schedstats 提供睡眠时长
+    sysctl -q -w kernel.sched_schedstats=1
+    perf record -q -g -o "$FOLDED".data -p "$PID" \
+        -e sched:sched_switch -e sched:sched_stat_sleep -e sched:sched_stat_blocked -e sched:sched_stat_iowait \
+        -- sleep "$SECONDS_TO_TRACE"
+    perf inject -s -i "$FOLDED".data -o "$FOLDED".inj
+    # 按 sched_stat 事件的 period (纳秒) 累加，输出毫秒
+    perf script -i "$FOLDED".inj -F comm,pid,tid,cpu,time,period,event,ip,sym,dso,trace | awk '
+        NF > 4 { exec = $1; period_ms = int($5 / 1000000) }
+        NF > 1 && NF <= 4 && period_ms > 0 { print $2 }
+        NF < 2 && period_ms > 0 { printf "%s\n%s\n\n", exec, period_ms }' | \
+        stackcollapse.pl > "$FOLDED"
+    COUNTNAME=ms
+fi
+
+"$FLAMEGRAPH" --title="Off-CPU Time (pid $PID)" --countname=$COUNTNAME --colors=io < "$FOLDED" > "$OUT"
+echo "wrote $OUT"
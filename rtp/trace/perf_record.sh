@@ -0,0 +1,27 @@
+#!/bin/bash
+# 用 perf 记录 rtp_probes.h 的 USDT 探针 (带调用栈)，再用 perf_stages.py 算各阶段时延。
+#
+# 用法: sudo ./perf_record.sh <可执行文件> <pid> [秒数]
+#   sudo perf script -i rtp-usdt.data | ./perf_stages.py
+#   同一份数据也可以做火焰图: perf script -i rtp-usdt.data | stackcollapse-perf.pl | flamegraph.pl > stages.svg
+
+set -e
+
+BIN=$1
+PID=$2
+SECONDS_TO_TRACE=${3:-10}
+
+if [ -z "$BIN" ] || [ -z "$PID" ]; then
+    echo "usage: $0 <binary> <pid> [seconds]" >&2
+    exit 1
+fi
+
+# 把二进制里的 SDT 注记登记到 perf，生成 sdt_rtp:* 事件
+perf buildid-cache --add "$BIN"
+for probe in packet_received packet_queued packet_dequeued frame_decoded frame_played packet_sent; do
+    perf probe -q -d "sdt_rtp:$probe" 2>/dev/null || true
+    perf probe -q -x "$BIN" "sdt_rtp:$probe" 2>/dev/null || echo "probe $probe not found in $BIN"
+done
+
+perf record -o rtp-usdt.data -e 'sdt_rtp:*' --call-graph fp -p "$PID" -- sleep "$SECONDS_TO_TRACE"
+echo "recorded rtp-usdt.data"
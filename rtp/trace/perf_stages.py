@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+"""
+从 perf script 的输出计算各阶段时延直方图 (微秒)，和 stage_latency.bt 的结果对应。
+
+用法: perf script -i rtp-usdt.data | ./perf_stages.py
+"""
+
+import re
+import sys
+from collections import defaultdict
+
+STAGES = ['packet_received', 'packet_queued', 'packet_dequeued', 'frame_decoded', 'frame_played']
+# 一个包拆成几个播放帧时，这两个阶段每包一次，其余阶段每帧一次
+PACKET_STAGES = STAGES[:2]
+
+EVENT = re.compile(r'\s(\d+\.\d+):\s+sdt_rtp:(\w+):.*?arg1=(\S+)\s+arg2=(\S+)\s+arg3=(\S+)\s+arg4=(\S+)')
+
+
+def hist(values):
+    buckets = defaultdict(int)
+    for v in values:
+        b = 0
+        while (1 << (b + 1)) <= v:
+            b += 1
+        buckets[b if v > 0 else -1] += 1
+    peak = max(buckets.values())
+    for b in sorted(buckets):
+        lo, hi = (0, 1) if b < 0 else (1 << b, 1 << (b + 1))
+        print('  [%6d, %6d) %8d |%s' % (lo, hi, buckets[b], '@' * (buckets[b] * 50 // peak)))
+
+
+def main():
+    # (session, ssrc, 媒体包 timestamp) -> {stage: 秒}，同一个包的播放帧共用
+    frames = defaultdict(dict)
+    latencies = defaultdict(list)
+    last_sent = {}
+    for line in sys.stdin:
+        m = EVENT.search(line)
+        if not m:
+            continue
+        t = float(m.group(1))
+        stage = m.group(2)
+        session, ssrc, _, ts = (int(x, 0) for x in m.group(3, 4, 5, 6))
+        if stage == 'packet_sent':
+            if session in last_sent:
+                latencies['send interval'].append((t - last_sent[session]) * 1e6)
+            last_sent[session] = t
+            continue
+        f = frames[(session, ssrc, ts)]
+        f[stage] = t
+        if stage == 'frame_played':
+            prev = None
+            for s in STAGES:
+                if s in f:
+                    if prev and not (s in PACKET_STAGES and f.get('counted')):
+                        latencies['%s -> %s' % (prev, s)].append((f[s] - f[prev]) * 1e6)
+                    prev = s
+            if 'packet_received' in f:
+                latencies['received -> played (total)'].append((t - f['packet_received']) * 1e6)
+            # 包级阶段留给同一个包的下一帧
+            f['counted'] = True
+            for s in STAGES[len(PACKET_STAGES):]:
+                f.pop(s, None)
+
+    for name in sorted(latencies):
+        values = sorted(latencies[name])
+        print('%s: n=%d p50=%.0f p99=%.0f max=%.0f us' % (
+            name, len(values), values[len(values) // 2], values[len(values) * 99 // 100], values[-1]))
+        hist(values)
+
+
+if __name__ == '__main__':
+    main()